@@ -5,25 +5,62 @@
 
 namespace esphome {
 namespace hlink_ac {
+#ifdef HLINK_AC_RAW_COMMANDS
 template<typename... Ts> class HlinkAcSendHlinkCmd : public Action<Ts...>, public Parented<HlinkAc> {
  public:
   TEMPLATABLE_VALUE(std::string, cmd_type)
   TEMPLATABLE_VALUE(std::string, address)
   TEMPLATABLE_VALUE(optional<std::string>, data)
+  TEMPLATABLE_VALUE(bool, force_read)
 
   void play(Ts... x) override {
     auto cmd_type = this->cmd_type_.value(x...);
     auto address = this->address_.value(x...);
     auto data = this->data_.value(x...);
-    this->parent_->send_hlink_cmd(cmd_type, address, data);
+    this->parent_->send_hlink_cmd(cmd_type, address, data, this->force_read_.value_or(x..., false));
   }
 };
 
+template<typename... Ts> class HlinkAcSendHlinkCmdBatch : public Action<Ts...>, public Parented<HlinkAc> {
+ public:
+  TEMPLATABLE_VALUE(std::string, commands)
+  TEMPLATABLE_VALUE(uint16_t, start_address)
+  TEMPLATABLE_VALUE(uint16_t, end_address)
+  TEMPLATABLE_VALUE(bool, force_read)
+  void set_json_result(bool json_result) { this->json_result_ = json_result; }
+
+  void play(Ts... x) override {
+    std::string commands = this->commands_.value_or(x..., "");
+    optional<uint16_t> start_address = {};
+    optional<uint16_t> end_address = {};
+    if (this->start_address_.has_value()) {
+      start_address = this->start_address_.value(x...);
+    }
+    if (this->end_address_.has_value()) {
+      end_address = this->end_address_.value(x...);
+    }
+    this->parent_->send_hlink_cmd_batch(commands, start_address, end_address, this->json_result_,
+                                        this->force_read_.value_or(x..., false));
+  }
+
+ protected:
+  bool json_result_{false};
+};
+#endif
+
 template<typename... Ts> class ResetAirFilterCleanWarning : public Action<Ts...>, public Parented<HlinkAc> {
  public:
   void play(Ts... x) override { this->parent_->reset_air_filter_clean_warning(); }
 };
 
+template<typename... Ts> class ExportHistory : public Action<Ts...>, public Parented<HlinkAc> {
+ public:
+  TEMPLATABLE_VALUE(uint16_t, max_samples)
+
+  void play(Ts... x) override { this->parent_->export_history(this->max_samples_.value_or(x..., 0)); }
+};
+
+#ifdef HLINK_AC_RAW_COMMANDS
 class SendHlinkCmdResultTrigger : public Trigger<const SendHlinkCmdResult &> {
  public:
   explicit SendHlinkCmdResultTrigger(HlinkAc *parent) {
@@ -31,10 +68,70 @@ class SendHlinkCmdResultTrigger : public Trigger<const SendHlinkCmdResult &> {
   }
 };
 
-#ifdef USE_TEXT_SENSOR
+class SendHlinkCmdBatchResultTrigger : public Trigger<std::string> {
+ public:
+  explicit SendHlinkCmdBatchResultTrigger(HlinkAc *parent) {
+    parent->add_send_hlink_cmd_batch_result_callback([this](const std::string &result) { this->trigger(result); });
+  }
+};
+#endif
+
+class HistoryExportTrigger : public Trigger<std::string> {
+ public:
+  explicit HistoryExportTrigger(HlinkAc *parent) {
+    parent->add_history_export_callback([this](const std::string &history) { this->trigger(history); });
+  }
+};
+
+// Fires once per real change of a single status field, with its new value
+template<typename T, optional<T> (HlinkEntityStatus::*Field)() const, uint16_t FieldBit> class StatusChangeTrigger
+    : public Trigger<T> {
+ public:
+  explicit StatusChangeTrigger(HlinkAc *parent) {
+    parent->add_on_status_change_callback([this](const HlinkEntityStatus &status, uint16_t changed_fields) {
+      optional<T> value = (status.*Field)();
+      if ((changed_fields & FieldBit) != 0 && value.has_value()) {
+        this->trigger(value.value());
+      }
+    });
+  }
+};
+
+using PowerChangeTrigger = StatusChangeTrigger<bool, &HlinkEntityStatus::power_state, HLINK_STATUS_POWER_STATE>;
+using ModeChangeTrigger =
+    StatusChangeTrigger<climate::ClimateMode, &HlinkEntityStatus::mode, HLINK_STATUS_MODE>;
+using ActionChangeTrigger =
+    StatusChangeTrigger<climate::ClimateAction, &HlinkEntityStatus::action, HLINK_STATUS_ACTION>;
+using CurrentTemperatureChangeTrigger =
+    StatusChangeTrigger<float, &HlinkEntityStatus::current_temperature, HLINK_STATUS_CURRENT_TEMPERATURE>;
+using TargetTemperatureChangeTrigger =
+    StatusChangeTrigger<float, &HlinkEntityStatus::target_temperature, HLINK_STATUS_TARGET_TEMPERATURE>;
+using FanModeChangeTrigger =
+    StatusChangeTrigger<climate::ClimateFanMode, &HlinkEntityStatus::fan_mode, HLINK_STATUS_FAN_MODE>;
+using SwingModeChangeTrigger =
+    StatusChangeTrigger<climate::ClimateSwingMode, &HlinkEntityStatus::swing_mode, HLINK_STATUS_SWING_MODE>;
+using OutdoorTemperatureChangeTrigger =
+    StatusChangeTrigger<int8_t, &HlinkEntityStatus::outdoor_temperature, HLINK_STATUS_OUTDOOR_TEMPERATURE>;
+using AlarmChangeTrigger = StatusChangeTrigger<uint16_t, &HlinkEntityStatus::alarm_code, HLINK_STATUS_ALARM_CODE>;
+
+#if defined(USE_TEXT_SENSOR) && defined(HLINK_AC_DEBUG_DISCOVERY)
 template<typename... Ts> class StartDebugDiscovery : public Action<Ts...>, public Parented<HlinkAc> {
  public:
-  void play(Ts... x) override { this->parent_->start_debug_discovery(); }
+  TEMPLATABLE_VALUE(uint16_t, start_address)
+  TEMPLATABLE_VALUE(uint16_t, end_address)
+  TEMPLATABLE_VALUE(bool, known_only)
+
+  void play(Ts... x) override {
+    optional<uint16_t> start_address = {};
+    optional<uint16_t> end_address = {};
+    if (this->start_address_.has_value()) {
+      start_address = this->start_address_.value(x...);
+    }
+    if (this->end_address_.has_value()) {
+      end_address = this->end_address_.value(x...);
+    }
+    this->parent_->start_debug_discovery(start_address, end_address, this->known_only_.value_or(x..., false));
+  }
 };
 
 template<typename... Ts> class StopDebugDiscovery : public Action<Ts...>, public Parented<HlinkAc> {
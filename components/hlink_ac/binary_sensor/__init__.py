@@ -1,7 +1,7 @@
 import esphome.codegen as cg
 from esphome.components import binary_sensor
 import esphome.config_validation as cv
-from esphome.const import ENTITY_CATEGORY_DIAGNOSTIC
+from esphome.const import DEVICE_CLASS_PROBLEM, ENTITY_CATEGORY_DIAGNOSTIC
 
 from ..climate import (
     CONF_HLINK_AC_ID,
@@ -13,6 +13,7 @@ CODEOWNERS = ["@lumixen"]
 BinarySensorTypeEnum = hlink_ac_ns.enum("BinarySensorType", True)
 
 CONF_AIR_FILTER_WARNING = "air_filter_warning"
+CONF_FAULT = "fault"
 
 ICON_AIR_FILTER_WARNING = "mdi:air-filter"
 
@@ -21,6 +22,10 @@ SENSOR_TYPES = {
         icon=ICON_AIR_FILTER_WARNING,
         entity_category=ENTITY_CATEGORY_DIAGNOSTIC,
     ),
+    CONF_FAULT: binary_sensor.binary_sensor_schema(
+        device_class=DEVICE_CLASS_PROBLEM,
+        entity_category=ENTITY_CATEGORY_DIAGNOSTIC,
+    ),
 }
 
 CONFIG_SCHEMA = cv.Schema(
@@ -1,3 +1,5 @@
+import logging
+
 from esphome import automation
 import esphome.codegen as cg
 import esphome.config_validation as cv
@@ -18,6 +20,8 @@ from esphome.const import (
     CONF_SUPPORTED_FAN_MODES,
     CONF_SUPPORTED_PRESETS,
     CONF_ID,
+    CONF_OPTIMISTIC,
+    CONF_PLATFORM,
     CONF_VISUAL,
     CONF_MIN_TEMPERATURE,
     CONF_MAX_TEMPERATURE,
@@ -25,6 +29,10 @@ from esphome.const import (
     CONF_TARGET_TEMPERATURE,
     CONF_TRIGGER_ID,
 )
+from esphome.core import CORE
+import esphome.final_validate as fv
+
+_LOGGER = logging.getLogger(__name__)
 
 CODEOWNERS = ["@lumixen"]
 DEPENDENCIES = ["climate", "uart"]
@@ -34,12 +42,53 @@ HlinkAc = hlink_ac_ns.class_("HlinkAc", cg.Component, uart.UARTDevice, climate.C
 SendHlinkCmdResult = hlink_ac_ns.struct("SendHlinkCmdResult")
 SendHlinkCmdResultConstRef = SendHlinkCmdResult.operator("ref").operator("const")
 InitialTargetTemperatures = hlink_ac_ns.struct("InitialTargetTemperatures")
+HlinkPollingDescriptor = hlink_ac_ns.struct("HlinkPollingDescriptor")
+HlinkPollingSubscriber = hlink_ac_ns.struct("HlinkPollingSubscriber")
+HlinkPollingFeature = hlink_ac_ns.struct("HlinkPollingFeature")
+HlinkDecoder = hlink_ac_ns.enum("HlinkDecoder", True)
+CustomRegisterType = hlink_ac_ns.enum("CustomRegisterType", True)
+RequestsQueueOverflowPolicy = hlink_ac_ns.enum("RequestsQueueOverflowPolicy", True)
 
 CONF_HLINK_AC_ID = "hlink_ac_id"
 CONF_STATUS_UPDATE_INTERVAL = "status_update_interval"
 CONF_REFERENCE_TEMPERATURE = "reference_temperature"
 CONF_INITIAL_TARGET_TEMPERATURES = "initial_target_temperatures"
 CONF_ON_SEND_HLINK_CMD_RESULT = "on_send_hlink_cmd_result"
+CONF_ON_SEND_HLINK_CMD_BATCH_RESULT = "on_send_hlink_cmd_batch_result"
+CONF_COMMANDS = "commands"
+CONF_START_ADDRESS = "start_address"
+CONF_END_ADDRESS = "end_address"
+CONF_RESULT_FORMAT = "result_format"
+CONF_FORCE_READ = "force_read"
+CONF_READ_CACHE_TTL = "read_cache_ttl"
+CONF_RAW_COMMANDS = "raw_commands"
+CONF_PASSIVE_MODE = "passive_mode"
+CONF_POLL_UNSEEN_FEATURES = "poll_unseen_features"
+CONF_LEARNING_PERIOD = "learning_period"
+CONF_REQUESTS_QUEUE = "requests_queue"
+CONF_HISTORY = "history"
+CONF_RESOLUTION = "resolution"
+CONF_THROTTLE_PUBLISHES = "throttle_publishes"
+CONF_MAX_SAMPLES = "max_samples"
+CONF_ON_HISTORY_EXPORT = "on_history_export"
+CONF_ON_POWER_CHANGE = "on_power_change"
+CONF_ON_MODE_CHANGE = "on_mode_change"
+CONF_ON_ACTION_CHANGE = "on_action_change"
+CONF_ON_CURRENT_TEMPERATURE_CHANGE = "on_current_temperature_change"
+CONF_ON_TARGET_TEMPERATURE_CHANGE = "on_target_temperature_change"
+CONF_ON_FAN_MODE_CHANGE = "on_fan_mode_change"
+CONF_ON_SWING_MODE_CHANGE = "on_swing_mode_change"
+CONF_ON_OUTDOOR_TEMPERATURE_CHANGE = "on_outdoor_temperature_change"
+CONF_ON_ALARM_CHANGE = "on_alarm_change"
+CONF_SIZE = "size"
+CONF_STRICT_POLL_BUDGET = "strict_poll_budget"
+CONF_OVERFLOW_POLICY = "overflow_policy"
+
+REQUESTS_QUEUE_OVERFLOW_POLICIES = {
+    "reject": RequestsQueueOverflowPolicy.REJECT,
+    "drop_oldest": RequestsQueueOverflowPolicy.DROP_OLDEST,
+    "coalesce": RequestsQueueOverflowPolicy.COALESCE_BY_ADDRESS,
+}
 
 PROTOCOL_MIN_TEMPERATURE = 16.0
 PROTOCOL_MAX_TEMPERATURE = 32.0
@@ -83,12 +132,291 @@ SUPPORTED_CLIMATE_PRESETS_OPTIONS = {
     "AWAY": ClimatePreset.CLIMATE_PRESET_AWAY,
 }
 
+# Addresses polled on every cycle regardless of the configuration, ordering is important:
+# mode and target temperature decoding depend on the power state read before them
+POLLED_CLIMATE_FEATURES = [
+    (0x0000, "power state", "POWER_STATE"),
+    (0x0001, "mode", "MODE"),
+    (0x0003, "target temperature", "TARGET_TEMP"),
+    (0x0100, "indoor temperature", "CURRENT_INDOOR_TEMP"),
+    (0x0002, "fan mode", "FAN_MODE"),
+]
+
+# Addresses polled once the matching platform entity is configured
+POLLED_PLATFORM_FEATURES = {
+    ("sensor", "outdoor_temperature"): (0x0102, "outdoor temperature", "CURRENT_OUTDOOR_TEMP"),
+    ("binary_sensor", "air_filter_warning"): (0x0302, "air filter warning", "AIR_FILTER_WARNING"),
+    ("switch", "remote_lock"): (0x0006, "remote lock", "REMOTE_CONTROL_LOCK"),
+    ("text_sensor", "model_name"): (0x0900, "model name", "MODEL_NAME"),
+    ("text_sensor", "alarm"): (0x0201, "alarm code", "ALARM_CODE"),
+    **{
+        ("sensor", key): (0x0301, "activity status", "ACTIVITY_STATUS")
+        for key in (
+            "compressor_on_time_hour",
+            "compressor_on_time_day",
+            "compressor_cycles_hour",
+            "compressor_mean_run_time",
+        )
+    },
+    ("binary_sensor", "fault"): (0x0201, "alarm code", "ALARM_CODE"),
+}
+
+CONF_DEBUG = "debug"
+CONF_CUSTOM_REGISTER = "custom_register"
+CONF_DATA_TYPE = "data_type"
+CONF_BITMASK = "bitmask"
+CONF_SCALE = "scale"
+CONF_OFFSET = "offset"
+CONF_POLL_INTERVAL = "poll_interval"
+
+CUSTOM_REGISTER_TYPES = {
+    "int8": CustomRegisterType.INT8,
+    "uint8": CustomRegisterType.UINT8,
+    "int16": CustomRegisterType.INT16,
+    "uint16": CustomRegisterType.UINT16,
+    "bitfield": CustomRegisterType.BITFIELD,
+}
+
+
+def validate_custom_register(config):
+    if config[CONF_DATA_TYPE] == "bitfield":
+        if CONF_BITMASK not in config:
+            raise cv.Invalid(f"'{CONF_BITMASK}' is required for the bitfield data type")
+    elif CONF_BITMASK in config:
+        raise cv.Invalid(f"'{CONF_BITMASK}' is only supported by the bitfield data type")
+    if config[CONF_SCALE] == 0:
+        raise cv.Invalid(f"'{CONF_SCALE}' can't be zero")
+    return config
+
+
+# Shared by the sensor and number custom_register entities
+CUSTOM_REGISTER_SCHEMA = {
+    cv.Required(CONF_ADDRESS): cv.hex_uint16_t,
+    cv.Optional(CONF_DATA_TYPE, default="uint16"): cv.one_of(*CUSTOM_REGISTER_TYPES, lower=True),
+    cv.Optional(CONF_BITMASK): cv.All(cv.hex_uint16_t, cv.Range(min=1)),
+    cv.Optional(CONF_SCALE, default=1.0): cv.float_,
+    cv.Optional(CONF_OFFSET, default=0.0): cv.float_,
+    cv.Optional(CONF_POLL_INTERVAL): cv.positive_time_period_milliseconds,
+}
+
+
+def hlink_platform_configs(full_config, domain, hlink_ac_id):
+    for conf in full_config.get(domain, []):
+        if (
+            conf.get(CONF_PLATFORM) == "hlink_ac"
+            and conf[CONF_HLINK_AC_ID].id == hlink_ac_id.id
+        ):
+            yield conf
+
+
+def debug_sensor_configs(full_config, hlink_ac_id):
+    """Returns debug text sensor configs in the order of their polling table entity indexes."""
+    return [
+        conf[CONF_DEBUG]
+        for conf in hlink_platform_configs(full_config, "text_sensor", hlink_ac_id)
+        if CONF_DEBUG in conf
+    ]
+
+
+def custom_register_configs(full_config, hlink_ac_id):
+    """Returns custom_register configs of all platforms in the order of their polling table entity indexes."""
+    return [
+        conf[CONF_CUSTOM_REGISTER]
+        for domain in ("sensor", "number")
+        for conf in hlink_platform_configs(full_config, domain, hlink_ac_id)
+        if CONF_CUSTOM_REGISTER in conf
+    ]
+
+
+def custom_register_to_code(parent, config):
+    """Registers the custom register of a sensor or number entity, returns its entity index."""
+    register_ids = [
+        conf[CONF_ID].id
+        for conf in custom_register_configs(CORE.config, config[CONF_HLINK_AC_ID])
+    ]
+    conf = config[CONF_CUSTOM_REGISTER]
+    index = register_ids.index(conf[CONF_ID].id)
+    cg.add(
+        parent.set_custom_register(
+            index,
+            conf[CONF_ADDRESS],
+            CUSTOM_REGISTER_TYPES[conf[CONF_DATA_TYPE]],
+            conf.get(CONF_BITMASK, 0xFFFF),
+            conf[CONF_SCALE],
+            conf[CONF_OFFSET],
+        )
+    )
+    return index
+
+
+def polled_features(full_config, hlink_ac_id):
+    """Returns [(address, name, decoder, entity index, poll interval)] polled by the given hlink_ac climate.
+
+    Features are listed in polling order.
+    """
+    features = list(POLLED_CLIMATE_FEATURES)
+    for climate_conf in full_config.get("climate", []):
+        if climate_conf[CONF_ID].id != hlink_ac_id.id:
+            continue
+        if set(climate_conf[CONF_SUPPORTED_SWING_MODES]) != {"OFF"}:
+            features.append((0x0014, "swing mode", "SWING_MODE"))
+        if "AWAY" in climate_conf[CONF_SUPPORTED_PRESETS]:
+            features.append((0x0304, "leave home status", "LEAVE_HOME_STATUS"))
+        if climate_conf[SUPPORT_HVAC_ACTIONS]:
+            features.append((0x0301, "activity status", "ACTIVITY_STATUS"))
+    for (domain, key), feature in POLLED_PLATFORM_FEATURES.items():
+        if feature not in features and any(
+            key in conf for conf in hlink_platform_configs(full_config, domain, hlink_ac_id)
+        ):
+            features.append(feature)
+    features = [(address, name, decoder, 0, 0) for address, name, decoder in features]
+    for index, debug_conf in enumerate(debug_sensor_configs(full_config, hlink_ac_id)):
+        features.append((debug_conf[CONF_ADDRESS], "debug sensor", "DEBUG_TEXT_SENSOR", index, 0))
+    for index, register_conf in enumerate(custom_register_configs(full_config, hlink_ac_id)):
+        poll_interval = register_conf.get(CONF_POLL_INTERVAL)
+        features.append(
+            (
+                register_conf[CONF_ADDRESS],
+                "custom register",
+                "CUSTOM_REGISTER",
+                index,
+                poll_interval.total_milliseconds if poll_interval else 0,
+            )
+        )
+    return features
+
+
+def polled_feature_addresses(full_config, hlink_ac_id):
+    """Returns {address: feature name} of the built-in features polled by the given hlink_ac climate."""
+    return {
+        address: name
+        for address, name, decoder, _, _ in polled_features(full_config, hlink_ac_id)
+        if decoder not in ("DEBUG_TEXT_SENSOR", "CUSTOM_REGISTER")
+    }
+
+
+def polled_addresses(full_config, hlink_ac_id):
+    """Returns {address: [(name, decoder, entity index, poll interval)]} in polling order."""
+    addresses = {}
+    for address, name, decoder, entity_index, poll_interval in polled_features(
+        full_config, hlink_ac_id
+    ):
+        addresses.setdefault(address, []).append((name, decoder, entity_index, poll_interval))
+    return addresses
+
+
+def address_poll_interval(address_subscribers):
+    """A shared address is read as often as its most demanding subscriber needs it."""
+    intervals = [poll_interval for _, _, _, poll_interval in address_subscribers]
+    return 0 if 0 in intervals else min(intervals)
+
+
+# Poll budget: every read waits for the gap after the previous response, then for the round trip of the
+# MT frame and its answer at 9600 baud
+POLL_FRAME_GAP_MS = 60
+POLL_TYPICAL_RTT_MS = 50
+POLL_READ_COST_MS = POLL_FRAME_GAP_MS + POLL_TYPICAL_RTT_MS
+
+
+def estimate_polling_cycle(full_config, hlink_ac_id, status_update_interval):
+    """Returns the estimated duration of a polling cycle in ms.
+
+    A cycle starts status_update_interval after the previous one finished. Addresses with a poll interval
+    are counted in proportion to the cycles they are read in.
+    """
+    addresses = polled_addresses(full_config, hlink_ac_id)
+    intervals = [address_poll_interval(subscribers) for subscribers in addresses.values()]
+    cycle_ms = intervals.count(0) * POLL_READ_COST_MS
+    period_ms = cycle_ms + status_update_interval
+    for poll_interval in intervals:
+        if poll_interval > 0:
+            cycle_ms += POLL_READ_COST_MS * min(1.0, period_ms / poll_interval)
+    return round(cycle_ms)
+
+
+def poll_budget_suggestions(full_config, hlink_ac_id, cycle_ms, period_ms):
+    """Returns the changes that would shorten the polling cycle or its share of the bus time."""
+    suggestions = [
+        f"set status_update_interval to at least {cycle_ms} ms to keep the bus idle at least half of the time"
+    ]
+    core_addresses = {address for address, _, _ in POLLED_CLIMATE_FEATURES}
+    optional_features = []
+    # Custom registers are the only addresses with a configurable cadence, every 10th cycle is suggested
+    suggested_interval_s = max(10, round(period_ms * 10 / 1000))
+    for address, subscribers in polled_addresses(full_config, hlink_ac_id).items():
+        if address in core_addresses or address_poll_interval(subscribers) != 0:
+            continue
+        if all(decoder == "CUSTOM_REGISTER" for _, decoder, _, _ in subscribers):
+            suggestions.append(
+                f"set poll_interval: {suggested_interval_s}s on the custom register {address:04X}"
+            )
+        else:
+            optional_features.append(f"{subscribers[0][0]} ({address:04X})")
+    if optional_features:
+        suggestions.append(
+            f"the {len(core_addresses)} core climate addresses are always read, remove the entities or climate "
+            "options of the built-in features you don't need, each of these is read on every cycle: "
+            + ", ".join(optional_features)
+        )
+    return suggestions
+
+
+def polling_table_to_code(var, hlink_ac_id):
+    """Emits the polling table of the given hlink_ac climate as flash constants.
+
+    Every address is read once per cycle, all of its subscribers decode the same response.
+    """
+    descriptors = []
+    subscribers = []
+    for address, address_subscribers in polled_addresses(CORE.config, hlink_ac_id).items():
+        checksum = 0xFFFF - (address >> 8) - (address & 0xFF)
+        frame = f"MT P={address:04X} C={checksum:04X}\\r"
+        poll_interval = address_poll_interval(address_subscribers)
+        descriptors.append(
+            f'{{0x{address:04X}, "{frame}", {len(subscribers)}, {len(address_subscribers)}, {poll_interval}}}'
+        )
+        subscribers.extend(
+            f"{{{getattr(HlinkDecoder, decoder)}, {entity_index}}}"
+            for _, decoder, entity_index, _ in address_subscribers
+        )
+    name = f"hlink_ac_polling_{hlink_ac_id.id}"
+    cg.add_global(
+        cg.RawStatement(
+            f"static const {HlinkPollingDescriptor} {name}_descriptors[] PROGMEM = {{"
+            + ", ".join(descriptors)
+            + "};"
+        )
+    )
+    cg.add_global(
+        cg.RawStatement(
+            f"static const {HlinkPollingSubscriber} {name}_subscribers[] PROGMEM = {{"
+            + ", ".join(subscribers)
+            + "};"
+        )
+    )
+    cg.add_global(
+        cg.RawStatement(f"static {HlinkPollingFeature} {name}_features[{len(descriptors)}];")
+    )
+    cg.add(
+        var.set_polling_table(
+            cg.RawExpression(f"{name}_descriptors"),
+            cg.RawExpression(f"{name}_subscribers"),
+            cg.RawExpression(f"{name}_features"),
+            len(descriptors),
+        )
+    )
+
+
 # Actions
 
 HlinkAcSendHlinkCmdAction = hlink_ac_ns.class_("HlinkAcSendHlinkCmd", automation.Action)
+HlinkAcSendHlinkCmdBatchAction = hlink_ac_ns.class_(
+    "HlinkAcSendHlinkCmdBatch", automation.Action
+)
 ResetAirFilterCleanWarningAction = hlink_ac_ns.class_(
     "ResetAirFilterCleanWarning", automation.Action
 )
+ExportHistoryAction = hlink_ac_ns.class_("ExportHistory", automation.Action)
 
 HLINK_BASE_ACTION_SCHEMA = automation.maybe_simple_id(
     {
@@ -102,6 +430,67 @@ SendHlinkCmdResultTrigger = hlink_ac_ns.class_(
     "SendHlinkCmdResultTrigger",
     automation.Trigger.template(SendHlinkCmdResultConstRef),
 )
+SendHlinkCmdBatchResultTrigger = hlink_ac_ns.class_(
+    "SendHlinkCmdBatchResultTrigger",
+    automation.Trigger.template(cg.std_string),
+)
+HistoryExportTrigger = hlink_ac_ns.class_(
+    "HistoryExportTrigger",
+    automation.Trigger.template(cg.std_string),
+)
+ClimateAction = climate.climate_ns.enum("ClimateAction")
+
+# Status change triggers: yaml key -> (trigger class, lambda argument type)
+STATUS_CHANGE_TRIGGERS = {
+    CONF_ON_POWER_CHANGE: (
+        hlink_ac_ns.class_("PowerChangeTrigger", automation.Trigger.template(cg.bool_)),
+        cg.bool_,
+    ),
+    CONF_ON_MODE_CHANGE: (
+        hlink_ac_ns.class_("ModeChangeTrigger", automation.Trigger.template(ClimateMode)),
+        ClimateMode,
+    ),
+    CONF_ON_ACTION_CHANGE: (
+        hlink_ac_ns.class_(
+            "ActionChangeTrigger", automation.Trigger.template(ClimateAction)
+        ),
+        ClimateAction,
+    ),
+    CONF_ON_CURRENT_TEMPERATURE_CHANGE: (
+        hlink_ac_ns.class_(
+            "CurrentTemperatureChangeTrigger", automation.Trigger.template(cg.float_)
+        ),
+        cg.float_,
+    ),
+    CONF_ON_TARGET_TEMPERATURE_CHANGE: (
+        hlink_ac_ns.class_(
+            "TargetTemperatureChangeTrigger", automation.Trigger.template(cg.float_)
+        ),
+        cg.float_,
+    ),
+    CONF_ON_FAN_MODE_CHANGE: (
+        hlink_ac_ns.class_(
+            "FanModeChangeTrigger", automation.Trigger.template(ClimateFanMode)
+        ),
+        ClimateFanMode,
+    ),
+    CONF_ON_SWING_MODE_CHANGE: (
+        hlink_ac_ns.class_(
+            "SwingModeChangeTrigger", automation.Trigger.template(ClimateSwingMode)
+        ),
+        ClimateSwingMode,
+    ),
+    CONF_ON_OUTDOOR_TEMPERATURE_CHANGE: (
+        hlink_ac_ns.class_(
+            "OutdoorTemperatureChangeTrigger", automation.Trigger.template(cg.int8)
+        ),
+        cg.int8,
+    ),
+    CONF_ON_ALARM_CHANGE: (
+        hlink_ac_ns.class_("AlarmChangeTrigger", automation.Trigger.template(cg.uint16)),
+        cg.uint16,
+    ),
+}
 
 
 @automation.register_action(
@@ -112,11 +501,13 @@ SendHlinkCmdResultTrigger = hlink_ac_ns.class_(
             cv.GenerateID(): cv.use_id(HlinkAc),
             cv.Required(CONF_ADDRESS): cv.templatable(cv.string),
             cv.Required(CONF_DATA): cv.templatable(cv.string),
+            cv.Optional(CONF_FORCE_READ): cv.templatable(cv.boolean),
         }
     ),
     synchronous=True,
 )
 async def send_hlink_cmd_to_code(config, action_id, template_arg, args):
+    cg.add_define("HLINK_AC_RAW_COMMANDS")
     var = cg.new_Pvariable(action_id, template_arg)
     await cg.register_parented(var, config[CONF_ID])
 
@@ -125,10 +516,64 @@ async def send_hlink_cmd_to_code(config, action_id, template_arg, args):
 
     cg.add(var.set_address(address_template))
     cg.add(var.set_data(data_template))
+    if CONF_FORCE_READ in config:
+        force_read = await cg.templatable(config[CONF_FORCE_READ], args, bool)
+        cg.add(var.set_force_read(force_read))
 
     return var
 
 
+def validate_send_hlink_cmd_batch(config):
+    if CONF_COMMANDS not in config and CONF_START_ADDRESS not in config:
+        raise cv.Invalid(
+            f"Either '{CONF_COMMANDS}' or '{CONF_START_ADDRESS}' and '{CONF_END_ADDRESS}' must be set"
+        )
+    if (CONF_START_ADDRESS in config) != (CONF_END_ADDRESS in config):
+        raise cv.Invalid(
+            f"'{CONF_START_ADDRESS}' and '{CONF_END_ADDRESS}' must be set together"
+        )
+    return config
+
+
+@automation.register_action(
+    "climate.hlink_ac.send_hlink_cmd_batch",
+    HlinkAcSendHlinkCmdBatchAction,
+    cv.All(
+        cv.Schema(
+            {
+                cv.GenerateID(): cv.use_id(HlinkAc),
+                cv.Optional(CONF_COMMANDS): cv.templatable(cv.string),
+                cv.Optional(CONF_START_ADDRESS): cv.templatable(cv.hex_uint16_t),
+                cv.Optional(CONF_END_ADDRESS): cv.templatable(cv.hex_uint16_t),
+                cv.Optional(CONF_RESULT_FORMAT, default="compact"): cv.one_of(
+                    "compact", "json", lower=True
+                ),
+                cv.Optional(CONF_FORCE_READ): cv.templatable(cv.boolean),
+            }
+        ),
+        validate_send_hlink_cmd_batch,
+    ),
+    synchronous=True,
+)
+async def send_hlink_cmd_batch_to_code(config, action_id, template_arg, args):
+    cg.add_define("HLINK_AC_RAW_COMMANDS")
+    var = cg.new_Pvariable(action_id, template_arg)
+    await cg.register_parented(var, config[CONF_ID])
+    if CONF_COMMANDS in config:
+        commands = await cg.templatable(config[CONF_COMMANDS], args, cg.std_string)
+        cg.add(var.set_commands(commands))
+    if CONF_START_ADDRESS in config:
+        start_address = await cg.templatable(config[CONF_START_ADDRESS], args, cg.uint16)
+        cg.add(var.set_start_address(start_address))
+        end_address = await cg.templatable(config[CONF_END_ADDRESS], args, cg.uint16)
+        cg.add(var.set_end_address(end_address))
+    cg.add(var.set_json_result(config[CONF_RESULT_FORMAT] == "json"))
+    if CONF_FORCE_READ in config:
+        force_read = await cg.templatable(config[CONF_FORCE_READ], args, bool)
+        cg.add(var.set_force_read(force_read))
+    return var
+
+
 @automation.register_action(
     "climate.hlink_ac.reset_air_filter_clean_warning",
     ResetAirFilterCleanWarningAction,
@@ -141,6 +586,26 @@ async def reset_air_filter_clean_warning_to_code(config, action_id, template_arg
     return var
 
 
+@automation.register_action(
+    "climate.hlink_ac.export_history",
+    ExportHistoryAction,
+    cv.Schema(
+        {
+            cv.GenerateID(): cv.use_id(HlinkAc),
+            cv.Optional(CONF_MAX_SAMPLES): cv.templatable(cv.uint16_t),
+        }
+    ),
+    synchronous=True,
+)
+async def export_history_to_code(config, action_id, template_arg, args):
+    var = cg.new_Pvariable(action_id, template_arg)
+    await cg.register_parented(var, config[CONF_ID])
+    if CONF_MAX_SAMPLES in config:
+        max_samples = await cg.templatable(config[CONF_MAX_SAMPLES], args, cg.uint16)
+        cg.add(var.set_max_samples(max_samples))
+    return var
+
+
 def validate_visual(config):
     if CONF_VISUAL in config:
         visual_config = config[CONF_VISUAL]
@@ -185,6 +650,42 @@ def validate_visual(config):
     return config
 
 
+def final_validate_poll_budget(config):
+    full_config = fv.full_config.get()
+    interval = config[CONF_STATUS_UPDATE_INTERVAL]
+    cycle_ms = estimate_polling_cycle(full_config, config[CONF_ID], interval)
+    if cycle_ms <= interval:
+        return config
+    period_ms = cycle_ms + interval
+    message = (
+        f"Polling the configured features takes about {cycle_ms} ms per cycle ({POLL_READ_COST_MS} ms per "
+        f"address), longer than the status_update_interval of {interval} ms, which is the pause between "
+        f"cycles. The effective refresh period is cycle + interval = ~{period_ms} ms and the bus is busy "
+        f"{round(cycle_ms * 100 / period_ms)}% of the time, control requests wait for the running cycle. "
+        "Suggestions: "
+        + "; ".join(poll_budget_suggestions(full_config, config[CONF_ID], cycle_ms, period_ms))
+    )
+    if config[CONF_STRICT_POLL_BUDGET]:
+        raise cv.Invalid(message, path=[CONF_STATUS_UPDATE_INTERVAL])
+    _LOGGER.warning(message)
+    return config
+
+
+def final_validate_requests_queue(config):
+    # The queue capacity is a build-wide define, every instance has to agree on it
+    size = config[CONF_REQUESTS_QUEUE][CONF_SIZE]
+    for climate_conf in fv.full_config.get().get("climate", []):
+        if climate_conf.get(CONF_PLATFORM) != "hlink_ac":
+            continue
+        other_size = climate_conf[CONF_REQUESTS_QUEUE][CONF_SIZE]
+        if other_size != size:
+            raise cv.Invalid(
+                f"All hlink_ac climates must use the same requests_queue size, got {size} and {other_size}",
+                path=[CONF_REQUESTS_QUEUE, CONF_SIZE],
+            )
+    return config
+
+
 def validate_initial_target_temperatures(config):
     if CONF_INITIAL_TARGET_TEMPERATURES in config:
         ref_temp = config.get(CONF_REFERENCE_TEMPERATURE, 25)
@@ -234,6 +735,38 @@ CONFIG_SCHEMA = cv.All(
                 CONF_STATUS_UPDATE_INTERVAL,
                 default="5000",
             ): cv.All(cv.uint32_t, cv.Range(min=100, max=60000)),
+            cv.Optional(CONF_STRICT_POLL_BUDGET, default=False): cv.boolean,
+            cv.Optional(
+                CONF_READ_CACHE_TTL,
+                default="0ms",
+            ): cv.positive_time_period_milliseconds,
+            cv.Optional(CONF_RAW_COMMANDS, default=False): cv.boolean,
+            cv.Optional(CONF_PASSIVE_MODE): cv.Schema(
+                {
+                    cv.Optional(CONF_POLL_UNSEEN_FEATURES, default=False): cv.boolean,
+                    cv.Optional(
+                        CONF_LEARNING_PERIOD, default="60s"
+                    ): cv.positive_time_period_milliseconds,
+                }
+            ),
+            cv.Optional(CONF_OPTIMISTIC, default=False): cv.boolean,
+            cv.Optional(CONF_REQUESTS_QUEUE, default={}): cv.Schema(
+                {
+                    cv.Optional(CONF_SIZE, default=16): cv.int_range(min=4, max=64),
+                    cv.Optional(CONF_OVERFLOW_POLICY, default="reject"): cv.enum(
+                        REQUESTS_QUEUE_OVERFLOW_POLICIES, lower=True
+                    ),
+                }
+            ),
+            cv.Optional(CONF_HISTORY): cv.Schema(
+                {
+                    cv.Optional(CONF_SIZE, default=288): cv.int_range(min=1, max=4096),
+                    cv.Optional(
+                        CONF_RESOLUTION, default="5min"
+                    ): cv.positive_time_period_milliseconds,
+                    cv.Optional(CONF_THROTTLE_PUBLISHES, default=False): cv.boolean,
+                }
+            ),
             cv.Optional(CONF_INITIAL_TARGET_TEMPERATURES): cv.Schema(
                 {
                     cv.Optional("cool"): cv.All(
@@ -258,6 +791,26 @@ CONFIG_SCHEMA = cv.All(
                     ),
                 }
             ),
+            cv.Optional(CONF_ON_SEND_HLINK_CMD_BATCH_RESULT): automation.validate_automation(
+                {
+                    cv.GenerateID(CONF_TRIGGER_ID): cv.declare_id(
+                        SendHlinkCmdBatchResultTrigger
+                    ),
+                }
+            ),
+            cv.Optional(CONF_ON_HISTORY_EXPORT): automation.validate_automation(
+                {
+                    cv.GenerateID(CONF_TRIGGER_ID): cv.declare_id(HistoryExportTrigger),
+                }
+            ),
+            **{
+                cv.Optional(key): automation.validate_automation(
+                    {
+                        cv.GenerateID(CONF_TRIGGER_ID): cv.declare_id(trigger_class),
+                    }
+                )
+                for key, (trigger_class, _) in STATUS_CHANGE_TRIGGERS.items()
+            },
         }
     )
     .extend(uart.UART_DEVICE_SCHEMA)
@@ -266,6 +819,8 @@ CONFIG_SCHEMA = cv.All(
     validate_initial_target_temperatures,
 )
 
+FINAL_VALIDATE_SCHEMA = cv.All(final_validate_poll_budget, final_validate_requests_queue)
+
 
 async def to_code(config):
     var = cg.new_Pvariable(config[CONF_ID])
@@ -274,7 +829,44 @@ async def to_code(config):
     await climate.register_climate(var, config)
 
     cg.add(var.set_status_update_interval(config[CONF_STATUS_UPDATE_INTERVAL]))
+    cg.add(
+        var.set_polling_cycle_estimate(
+            estimate_polling_cycle(
+                CORE.config, config[CONF_ID], config[CONF_STATUS_UPDATE_INTERVAL]
+            )
+        )
+    )
+    # Raw commands are compiled in only when an action, trigger or lambda makes use of them
+    if (
+        config[CONF_RAW_COMMANDS]
+        or config[CONF_READ_CACHE_TTL].total_milliseconds > 0
+        or CONF_ON_SEND_HLINK_CMD_RESULT in config
+        or CONF_ON_SEND_HLINK_CMD_BATCH_RESULT in config
+    ):
+        cg.add_define("HLINK_AC_RAW_COMMANDS")
+    if config[CONF_READ_CACHE_TTL].total_milliseconds > 0:
+        cg.add(var.set_read_cache_ttl(config[CONF_READ_CACHE_TTL]))
+    if passive_mode := config.get(CONF_PASSIVE_MODE):
+        cg.add(
+            var.set_passive_mode(
+                passive_mode[CONF_POLL_UNSEEN_FEATURES],
+                passive_mode[CONF_LEARNING_PERIOD],
+            )
+        )
     cg.add(var.set_reference_temperature(config[CONF_REFERENCE_TEMPERATURE]))
+    if config[CONF_OPTIMISTIC]:
+        cg.add(var.set_optimistic(True))
+    if history := config.get(CONF_HISTORY):
+        cg.add(
+            var.set_history(
+                history[CONF_SIZE],
+                history[CONF_RESOLUTION],
+                history[CONF_THROTTLE_PUBLISHES],
+            )
+        )
+    requests_queue = config[CONF_REQUESTS_QUEUE]
+    cg.add_define("HLINK_AC_REQUESTS_QUEUE_SIZE", requests_queue[CONF_SIZE])
+    cg.add(var.set_requests_queue_overflow_policy(requests_queue[CONF_OVERFLOW_POLICY]))
 
     if CONF_INITIAL_TARGET_TEMPERATURES in config:
         boot = config[CONF_INITIAL_TARGET_TEMPERATURES]
@@ -301,8 +893,23 @@ async def to_code(config):
     if SUPPORT_HVAC_ACTIONS in config:
         cg.add(var.set_support_hvac_actions(config[SUPPORT_HVAC_ACTIONS]))
 
+    polling_table_to_code(var, config[CONF_ID])
+
     for conf in config.get(CONF_ON_SEND_HLINK_CMD_RESULT, []):
         trigger = cg.new_Pvariable(conf[CONF_TRIGGER_ID], var)
         await automation.build_automation(
             trigger, [(SendHlinkCmdResultConstRef, "result")], conf
         )
+
+    for conf in config.get(CONF_ON_SEND_HLINK_CMD_BATCH_RESULT, []):
+        trigger = cg.new_Pvariable(conf[CONF_TRIGGER_ID], var)
+        await automation.build_automation(trigger, [(cg.std_string, "result")], conf)
+
+    for conf in config.get(CONF_ON_HISTORY_EXPORT, []):
+        trigger = cg.new_Pvariable(conf[CONF_TRIGGER_ID], var)
+        await automation.build_automation(trigger, [(cg.std_string, "history")], conf)
+
+    for key, (_, value_type) in STATUS_CHANGE_TRIGGERS.items():
+        for conf in config.get(key, []):
+            trigger = cg.new_Pvariable(conf[CONF_TRIGGER_ID], var)
+            await automation.build_automation(trigger, [(value_type, "x")], conf)
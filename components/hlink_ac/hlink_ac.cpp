@@ -1,113 +1,78 @@
 #include "esphome/core/log.h"
 #include "hlink_ac.h"
+#include "registers.h"
+
+#ifdef HLINK_AC_ALLOCATION_ACCOUNTING
+#include <esp_attr.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+// Task inside a counted component scope, nullptr while no scope is counted
+static void *volatile hlink_ac_counted_task = nullptr;
+static volatile uint32_t hlink_ac_heap_allocations = 0;
+
+// Called by the ESP-IDF heap on every allocation of every task (CONFIG_HEAP_USE_HOOKS), any allocator included
+extern "C" void IRAM_ATTR esp_heap_trace_alloc_hook(void *ptr, size_t size, uint32_t caps) {
+  if (hlink_ac_counted_task != nullptr && xTaskGetCurrentTaskHandle() == hlink_ac_counted_task) {
+    hlink_ac_heap_allocations++;
+  }
+}
+#endif
 
 namespace esphome {
 namespace hlink_ac {
 static const char *const TAG = "hlink_ac";
 
+#ifdef HLINK_AC_ALLOCATION_ACCOUNTING
+HlinkAllocationScope::HlinkAllocationScope(bool counted) : previous_task_(hlink_ac_counted_task) {
+  hlink_ac_counted_task = counted ? xTaskGetCurrentTaskHandle() : nullptr;
+}
+
+HlinkAllocationScope::~HlinkAllocationScope() { hlink_ac_counted_task = this->previous_task_; }
+
+uint32_t HlinkAllocationScope::allocations() { return hlink_ac_heap_allocations; }
+#endif
+
 const HlinkResponseFrame HLINK_RESPONSE_NOTHING = {HlinkResponseFrame::Status::NOTHING};
 const HlinkResponseFrame HLINK_RESPONSE_PARTIAL = {HlinkResponseFrame::Status::PARTIAL};
 const HlinkResponseFrame HLINK_RESPONSE_INVALID = {HlinkResponseFrame::Status::INVALID};
+const HlinkResponseFrame HLINK_RESPONSE_COLLISION = {HlinkResponseFrame::Status::COLLISION};
 const HlinkResponseFrame HLINK_RESPONSE_ACK_OK = {HlinkResponseFrame::Status::OK};
 
-HlinkAc::HlinkAc() {
-  // Setup default polling features, ordering is important
-  this->status_.polling_features.push_back(
-      {{HlinkRequestFrame::Type::MT, {FeatureType::POWER_STATE}}, [this](const HlinkResponseFrame &response) {
-         auto power_state = response.p_value_as_uint16();
-         if (power_state.has_value()) {
-           this->hlink_entity_status_.power_state = static_cast<bool>(power_state.value());
-         } else {
-           this->hlink_entity_status_.power_state = {};
-         }
-       }});
-  this->status_.polling_features.push_back(
-      {{HlinkRequestFrame::Type::MT, {FeatureType::MODE}}, [this](const HlinkResponseFrame &response) {
-         if (!this->hlink_entity_status_.power_state.has_value()) {
-           ESP_LOGW(TAG, "Can't handle climate mode response without power state data");
-           return;
-         }
-         this->hlink_entity_status_.hlink_climate_mode = response.p_value_as_uint16();
-         if (!this->hlink_entity_status_.power_state.value()) {
-           // Climate mode should be off when device is turned off
-           this->hlink_entity_status_.mode = esphome::climate::ClimateMode::CLIMATE_MODE_OFF;
-           return;
-         }
-         if (this->hlink_entity_status_.hlink_climate_mode == HLINK_MODE_HEAT) {
-           this->hlink_entity_status_.mode = esphome::climate::ClimateMode::CLIMATE_MODE_HEAT;
-         } else if (this->hlink_entity_status_.hlink_climate_mode == HLINK_MODE_COOL) {
-           this->hlink_entity_status_.mode = esphome::climate::ClimateMode::CLIMATE_MODE_COOL;
-         } else if (this->hlink_entity_status_.hlink_climate_mode == HLINK_MODE_DRY) {
-           this->hlink_entity_status_.mode = esphome::climate::ClimateMode::CLIMATE_MODE_DRY;
-         } else if (this->hlink_entity_status_.hlink_climate_mode == HLINK_MODE_FAN) {
-           this->hlink_entity_status_.mode = esphome::climate::ClimateMode::CLIMATE_MODE_FAN_ONLY;
-         } else if (this->hlink_entity_status_.hlink_climate_mode == HLINK_MODE_HEAT_AUTO) {
-           this->hlink_entity_status_.mode = esphome::climate::ClimateMode::CLIMATE_MODE_HEAT_COOL;
-         } else if (this->hlink_entity_status_.hlink_climate_mode == HLINK_MODE_COOL_AUTO) {
-           this->hlink_entity_status_.mode = esphome::climate::ClimateMode::CLIMATE_MODE_HEAT_COOL;
-         } else if (this->hlink_entity_status_.hlink_climate_mode == HLINK_MODE_DRY_AUTO) {
-           this->hlink_entity_status_.mode = esphome::climate::ClimateMode::CLIMATE_MODE_HEAT_COOL;
-         } else if (this->hlink_entity_status_.hlink_climate_mode == HLINK_MODE_AUTO) {
-           this->hlink_entity_status_.mode = esphome::climate::ClimateMode::CLIMATE_MODE_HEAT_COOL;
-         }
-       }});
-  this->status_.polling_features.push_back(
-      {{HlinkRequestFrame::Type::MT, {FeatureType::TARGET_TEMP}}, [this](const HlinkResponseFrame &response) {
-         if (this->hlink_entity_status_.power_state.has_value() && !this->hlink_entity_status_.power_state.value()) {
-           this->hlink_entity_status_.target_temperature = NAN;
-           return;
-         }
-         if (response.p_value_as_uint16().has_value()) {
-           uint16_t target_temperature = response.p_value_as_uint16().value();
-           if (this->hlink_entity_status_.hlink_climate_mode.has_value() &&
-               this->is_auto_temperature_mode_(this->hlink_entity_status_.hlink_climate_mode.value()) &&
-               target_temperature >= 0xFF00) {
-             // In auto mode the target temperature control is not available
-             // Instead, AC expects temperature offset in range [-3;+3] C
-             // AUTO HEATING: FFFD -> FFFF, FFFE -> FF00, FFFF -> FF01, FF00 -> FF02, FF01 -> FF03, FF02 -> FF04, FF03
-             // -> FF05
-             // AUTO COOLING: FFFD -> FFFB, FFFE -> FFFC, FFFF -> FFFD, FF00 -> FFFE, FF01 -> FFFF, FF02 ->
-             // FF00, FF03 -> FF01
-             // Needs testing, it's not clear if offset makes any difference in real life
-             int8_t offset_temp = static_cast<int8_t>(target_temperature - 0xFF00);
-             int8_t adjusted_offset = offset_temp;
-             if (this->hlink_entity_status_.hlink_climate_mode == HLINK_MODE_HEAT_AUTO) {
-               adjusted_offset = offset_temp - 2;
-             } else if (this->hlink_entity_status_.hlink_climate_mode == HLINK_MODE_COOL_AUTO) {
-               adjusted_offset = offset_temp + 2;
-             }
-             this->hlink_entity_status_.target_temperature =
-                 this->clamp_auto_temperature_(this->reference_temperature_ + adjusted_offset);
-           } else if (target_temperature >= PROTOCOL_TARGET_TEMP_MIN &&
-                      target_temperature <= PROTOCOL_TARGET_TEMP_MAX) {
-             this->hlink_entity_status_.target_temperature = target_temperature;
-           } else {
-             this->hlink_entity_status_.target_temperature = NAN;
-           }
-         }
-       }});
-  this->status_.polling_features.push_back(
-      {{HlinkRequestFrame::Type::MT, {FeatureType::CURRENT_INDOOR_TEMP}}, [this](const HlinkResponseFrame &response) {
-         this->hlink_entity_status_.current_temperature = response.p_value_as_uint16();
-#ifdef USE_SENSOR
-         this->update_sensor_state_(this->indoor_temperature_sensor_,
-                                    this->hlink_entity_status_.current_temperature.value_or(NAN));
-#endif
-       }});
-  this->status_.polling_features.push_back(
-      {{HlinkRequestFrame::Type::MT, {FeatureType::FAN_MODE}}, [this](const HlinkResponseFrame &response) {
-         if (response.p_value_as_uint16() == HLINK_FAN_AUTO) {
-           this->hlink_entity_status_.fan_mode = esphome::climate::ClimateFanMode::CLIMATE_FAN_AUTO;
-         } else if (response.p_value_as_uint16() == HLINK_FAN_HIGH) {
-           this->hlink_entity_status_.fan_mode = esphome::climate::ClimateFanMode::CLIMATE_FAN_HIGH;
-         } else if (response.p_value_as_uint16() == HLINK_FAN_MEDIUM) {
-           this->hlink_entity_status_.fan_mode = esphome::climate::ClimateFanMode::CLIMATE_FAN_MEDIUM;
-         } else if (response.p_value_as_uint16() == HLINK_FAN_LOW) {
-           this->hlink_entity_status_.fan_mode = esphome::climate::ClimateFanMode::CLIMATE_FAN_LOW;
-         } else if (response.p_value_as_uint16() == HLINK_FAN_QUIET) {
-           this->hlink_entity_status_.fan_mode = esphome::climate::ClimateFanMode::CLIMATE_FAN_QUIET;
-         }
-       }});
+// Outdoor temperature is reported as 7E while the unit is not running
+static bool is_outdoor_temperature_informative(const HlinkEntityStatus &status) {
+  return status.power_state().value_or(true);
+}
+
+// Activity status is meaningless while the unit is off and always 0000 in fan mode
+static bool is_activity_status_informative(const HlinkEntityStatus &status) {
+  return status.power_state().value_or(true) && status.hlink_climate_mode() != HLINK_MODE_FAN;
+}
+
+// Features required for the minimal climate status are never excluded from polling
+static bool is_essential_polling_feature(uint16_t address) {
+  return address == FeatureType::POWER_STATE || address == FeatureType::MODE || address == FeatureType::TARGET_TEMP ||
+         address == FeatureType::CURRENT_INDOOR_TEMP;
+}
+
+static bool is_hex_string(const std::string &value) {
+  for (char c : value) {
+    if (!std::isxdigit(static_cast<unsigned char>(c))) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Copies a polling table entry out of flash
+template<typename T> static T progmem_read_struct(const T *source) {
+  T copy;
+  const uint8_t *source_bytes = reinterpret_cast<const uint8_t *>(source);
+  uint8_t *copy_bytes = reinterpret_cast<uint8_t *>(&copy);
+  for (size_t i = 0; i < sizeof(T); i++) {
+    copy_bytes[i] = progmem_read_byte(source_bytes + i);
+  }
+  return copy;
 }
 
 void HlinkAc::setup() {
@@ -122,6 +87,18 @@ void HlinkAc::setup() {
   if (this->beeper_switch_ != nullptr && beeper_enabled != this->beeper_switch_->state) {
     this->beeper_switch_->publish_state(beeper_enabled);
   }
+#endif
+  this->load_capabilities_();
+#if defined(USE_TEXT_SENSOR) && defined(HLINK_AC_DEBUG_DISCOVERY)
+  if (this->debug_discovery_text_sensor_ != nullptr) {
+    constexpr uint32_t debug_discovery_checkpoint_version = 0x5D1C0A26;
+    this->debug_discovery_rtc_ =
+        this->make_entity_preference<DebugDiscoveryCheckpoint>(debug_discovery_checkpoint_version);
+    if (this->debug_discovery_rtc_.load(&this->debug_discovery_) && this->debug_discovery_.in_progress) {
+      ESP_LOGI(TAG, "Interrupted debug discovery can be resumed from %04X with start_debug_discovery",
+               this->debug_discovery_.next_address);
+    }
+  }
 #endif
   if (this->initial_target_temperatures_.heat_target_temperature.has_value()) {
     ESP_LOGI(TAG, "Setting initial heat target temperature: %.1f",
@@ -161,10 +138,23 @@ void HlinkAc::setup() {
     this->enqueue_request_(
         HlinkRequestFrame::with_uint16(HlinkRequestFrame::Type::ST, FeatureType::TARGET_TEMP, encoded));
   }
+#if defined(HLINK_AC_ALLOCATION_ACCOUNTING) && defined(USE_SENSOR)
+  // Published from the scheduler, so the publish itself isn't counted as an allocation of loop()
+  this->set_interval(ALLOCATION_STATS_PUBLISH_INTERVAL, [this]() {
+    this->update_sensor_state_(this->loop_heap_allocations_sensor_, this->allocation_stats_.window_max_loop);
+    this->allocation_stats_.window_max_loop = 0;
+  });
+#endif
   ESP_LOGI(TAG, "Component initialized.");
 }
 
 void HlinkAc::dump_config() {
+  const char *model_name = "N/A";
+#ifdef USE_TEXT_SENSOR
+  if (this->model_name_text_sensor_ != nullptr && !this->model_name_text_sensor_->state.empty()) {
+    model_name = this->model_name_text_sensor_->state.c_str();
+  }
+#endif
   ESP_LOGCONFIG(
       TAG,
       "Hlink AC:\n"
@@ -175,31 +165,80 @@ void HlinkAc::dump_config() {
       "  Current temperature: %s\n"
       "  Target temperature: %s\n"
       "  Model: %s",
-      this->hlink_entity_status_.power_state.has_value() ? this->hlink_entity_status_.power_state.value() ? "ON" : "OFF"
-                                                         : "N/A",
-      this->hlink_entity_status_.mode.has_value()
-          ? LOG_STR_ARG(climate_mode_to_string(this->hlink_entity_status_.mode.value()))
+      this->hlink_entity_status_.power_state().has_value()
+          ? this->hlink_entity_status_.power_state().value() ? "ON" : "OFF"
+          : "N/A",
+      this->hlink_entity_status_.mode().has_value()
+          ? LOG_STR_ARG(climate_mode_to_string(this->hlink_entity_status_.mode().value()))
           : "N/A",
-      this->hlink_entity_status_.fan_mode.has_value()
-          ? LOG_STR_ARG(climate_fan_mode_to_string(this->hlink_entity_status_.fan_mode.value()))
+      this->hlink_entity_status_.fan_mode().has_value()
+          ? LOG_STR_ARG(climate_fan_mode_to_string(this->hlink_entity_status_.fan_mode().value()))
           : "N/A",
-      this->hlink_entity_status_.swing_mode.has_value()
-          ? LOG_STR_ARG(climate_swing_mode_to_string(this->hlink_entity_status_.swing_mode.value()))
+      this->hlink_entity_status_.swing_mode().has_value()
+          ? LOG_STR_ARG(climate_swing_mode_to_string(this->hlink_entity_status_.swing_mode().value()))
           : "N/A",
-      this->hlink_entity_status_.current_temperature.has_value()
-          ? std::to_string(static_cast<int16_t>(this->hlink_entity_status_.current_temperature.value())).c_str()
+      this->hlink_entity_status_.current_temperature().has_value()
+          ? std::to_string(static_cast<int16_t>(this->hlink_entity_status_.current_temperature().value())).c_str()
           : "N/A",
       this->format_target_temperature_log_(
-              this->hlink_entity_status_.target_temperature,
-              this->hlink_entity_status_.hlink_climate_mode.has_value() &&
-                  this->is_auto_temperature_mode_(this->hlink_entity_status_.hlink_climate_mode.value()))
+              this->hlink_entity_status_.target_temperature(),
+              this->hlink_entity_status_.hlink_climate_mode().has_value() &&
+                  this->is_auto_temperature_mode_(this->hlink_entity_status_.hlink_climate_mode().value()))
           .c_str(),
-      this->hlink_entity_status_.model_name.has_value() ? this->hlink_entity_status_.model_name.value().c_str()
-                                                        : "N/A");
+      model_name);
+  size_t polling_subscribers = 0;
+  for (int16_t i = 0; i < this->status_.polling_features_count; i++) {
+    polling_subscribers += this->read_polling_descriptor_(i).subscriber_count;
+  }
+  ESP_LOGCONFIG(TAG, "  Polled addresses: %u (%u subscribers)", this->status_.polling_features_count,
+                static_cast<unsigned>(polling_subscribers));
+  ESP_LOGCONFIG(TAG, "  Polling cycle: estimated %lu ms, last %lu ms, status update interval %lu ms",
+                this->polling_cycle_estimate_ms_, this->status_.last_polling_cycle_ms,
+                this->status_.status_update_interval_ms);
+  ESP_LOGCONFIG(TAG, "  Optimistic control: %s", YESNO(this->optimistic_));
+  ESP_LOGCONFIG(TAG, "  Control latency (%lu acknowledged requests):", this->control_latency_.end_to_end.samples);
+  this->log_latency_stats_("Queued", this->control_latency_.queued);
+  this->log_latency_stats_("Bus", this->control_latency_.bus);
+  this->log_latency_stats_("Publish", this->control_latency_.publish);
+  this->log_latency_stats_("End-to-end", this->control_latency_.end_to_end);
+  RequestsQueueOverflowPolicy overflow_policy = this->pending_action_requests_.get_overflow_policy();
+  ESP_LOGCONFIG(TAG, "  Requests queue: capacity %u, high-water mark %u, overflow policy %s, overflows: %lu",
+                RequestsQueue::capacity(), this->pending_action_requests_.high_water_mark(),
+                overflow_policy == RequestsQueueOverflowPolicy::DROP_OLDEST           ? "drop_oldest"
+                : overflow_policy == RequestsQueueOverflowPolicy::COALESCE_BY_ADDRESS ? "coalesce"
+                                                                                      : "reject",
+                this->queue_overflows_);
+  ESP_LOGCONFIG(TAG, "  Request retries: %lu, dropped requests: %lu", this->retried_requests_,
+                this->dropped_requests_);
+  ESP_LOGCONFIG(TAG, "  Frame timeout: %lu ms (p99 response time: %lu ms, samples: %u, timeouts: %lu)",
+                this->status_.response_times.frame_timeout_ms, this->status_.response_times.percentile_ms(99),
+                this->status_.response_times.samples, this->status_.response_times.timeouts);
+#ifdef HLINK_AC_ALLOCATION_ACCOUNTING
+  ESP_LOGCONFIG(TAG, "  Heap allocations in loop(): %lu total, %lu max per loop, %lu loops with allocations",
+                this->allocation_stats_.total, this->allocation_stats_.max_loop,
+                this->allocation_stats_.loops_with_allocations);
+#endif
+  ESP_LOGCONFIG(TAG, "  Bus contention events: %lu, foreign frames: %lu, unrecognized frames: %lu",
+                this->contention_events_, this->sniffer_.foreign_frames, this->sniffer_.noise_frames);
+  if (this->passive_mode_) {
+    ESP_LOGCONFIG(TAG, "  Passive mode: polling unseen features %s, decoded responses: %lu",
+                  this->passive_poll_unseen_features_ ? "ON" : "OFF", this->sniffer_.decoded_responses);
+  }
+#ifdef HLINK_AC_RAW_COMMANDS
+  if (this->status_.read_cache.ttl_ms > 0) {
+    ESP_LOGCONFIG(TAG, "  Read cache TTL: %lu ms, hits: %lu", this->status_.read_cache.ttl_ms,
+                  this->status_.read_cache.hits);
+  }
+#endif
+  for (int16_t i = 0; i < this->status_.polling_features_count; i++) {
+    if (this->status_.polling_features[i].unsupported) {
+      ESP_LOGCONFIG(TAG, "  Unsupported address: %04X", this->read_polling_descriptor_(i).address);
+    }
+  }
 #ifdef USE_SWITCH
   ESP_LOGCONFIG(TAG, "  Remote lock: %s",
-                this->hlink_entity_status_.remote_control_lock.has_value()
-                    ? this->hlink_entity_status_.remote_control_lock.value() ? "ON" : "OFF"
+                this->hlink_entity_status_.remote_control_lock().has_value()
+                    ? this->hlink_entity_status_.remote_control_lock().value() ? "ON" : "OFF"
                     : "N/A");
 #endif
   this->check_uart_settings(9600, 1, uart::UART_CONFIG_PARITY_ODD, 8);
@@ -209,6 +248,20 @@ void HlinkAc::set_status_update_interval(uint32_t interval_ms) {
   this->status_.status_update_interval_ms = interval_ms;
 }
 
+void HlinkAc::set_history(uint16_t size, uint32_t resolution_ms, bool throttle_publishes) {
+  this->history_.configure(size, resolution_ms, throttle_publishes);
+}
+
+void HlinkAc::set_requests_queue_overflow_policy(RequestsQueueOverflowPolicy policy) {
+  this->pending_action_requests_.set_overflow_policy(policy);
+}
+
+void HlinkAc::set_passive_mode(bool poll_unseen_features, uint32_t learning_period_ms) {
+  this->passive_mode_ = true;
+  this->passive_poll_unseen_features_ = poll_unseen_features;
+  this->passive_learning_period_ms_ = learning_period_ms;
+}
+
 void HlinkAc::set_reference_temperature(float reference_temperature) {
   this->reference_temperature_ = reference_temperature;
 }
@@ -217,12 +270,429 @@ void HlinkAc::set_initial_target_temperatures(const InitialTargetTemperatures &c
   this->initial_target_temperatures_ = config;
 }
 
+void HlinkAc::set_polling_table(const HlinkPollingDescriptor *descriptors, const HlinkPollingSubscriber *subscribers,
+                                HlinkPollingFeature *features, uint8_t features_count) {
+  this->status_.polling_descriptors = descriptors;
+  this->status_.polling_subscribers = subscribers;
+  this->status_.polling_features = features;
+  this->status_.polling_features_count = features_count;
+}
+
+HlinkPollingDescriptor HlinkAc::read_polling_descriptor_(int16_t feature_index) const {
+  return progmem_read_struct(&this->status_.polling_descriptors[feature_index]);
+}
+
+HlinkPollingSubscriber HlinkAc::read_polling_subscriber_(uint8_t subscriber_index) const {
+  return progmem_read_struct(&this->status_.polling_subscribers[subscriber_index]);
+}
+
+bool HlinkAc::is_polling_feature_informative_(const HlinkPollingDescriptor &descriptor) const {
+  // Polling is only slowed down if every subscriber agrees on it
+  for (uint8_t i = 0; i < descriptor.subscriber_count; i++) {
+    switch (this->read_polling_subscriber_(descriptor.first_subscriber + i).decoder) {
+      case HlinkDecoder::CURRENT_OUTDOOR_TEMP:
+        if (is_outdoor_temperature_informative(this->hlink_entity_status_)) {
+          return true;
+        }
+        break;
+      case HlinkDecoder::ACTIVITY_STATUS:
+        if (is_activity_status_informative(this->hlink_entity_status_)) {
+          return true;
+        }
+        break;
+      // Alarms are checked at a low cadence until the unit reports one
+      case HlinkDecoder::ALARM_CODE:
+        if (!this->hlink_entity_status_.alarm_code().has_value() ||
+            this->hlink_entity_status_.alarm_code().value() != HLINK_NO_ALARM) {
+          return true;
+        }
+        break;
+      default:
+        return true;
+    }
+  }
+  return false;
+}
+
+void HlinkAc::decode_polling_response_(const HlinkPollingSubscriber &subscriber, const HlinkResponseFrame &response) {
+  switch (subscriber.decoder) {
+    case HlinkDecoder::POWER_STATE: {
+      auto power_state = response.p_value_as_uint16();
+      if (power_state.has_value()) {
+        this->hlink_entity_status_.set_power_state(static_cast<bool>(power_state.value()));
+      } else {
+        this->hlink_entity_status_.set_power_state({});
+      }
+      break;
+    }
+    case HlinkDecoder::MODE:
+      if (!this->hlink_entity_status_.power_state().has_value()) {
+        ESP_LOGW(TAG, "Can't handle climate mode response without power state data");
+        break;
+      }
+      this->hlink_entity_status_.set_hlink_climate_mode(response.p_value_as_uint16());
+      if (!this->hlink_entity_status_.power_state().value()) {
+        // Climate mode should be off when device is turned off
+        this->hlink_entity_status_.set_mode(esphome::climate::ClimateMode::CLIMATE_MODE_OFF);
+        break;
+      }
+      if (this->hlink_entity_status_.hlink_climate_mode().has_value()) {
+        auto mode = ClimateModeCodec::decode(this->hlink_entity_status_.hlink_climate_mode().value());
+        if (mode.has_value()) {
+          this->hlink_entity_status_.set_mode(mode);
+        }
+      }
+      break;
+    case HlinkDecoder::TARGET_TEMP:
+      if (this->hlink_entity_status_.power_state().has_value() && !this->hlink_entity_status_.power_state().value()) {
+        this->hlink_entity_status_.set_target_temperature(NAN);
+        break;
+      }
+      if (response.p_value_as_uint16().has_value()) {
+        uint16_t target_temperature = response.p_value_as_uint16().value();
+        if (this->hlink_entity_status_.hlink_climate_mode().has_value() &&
+            this->is_auto_temperature_mode_(this->hlink_entity_status_.hlink_climate_mode().value()) &&
+            target_temperature >= 0xFF00) {
+          // In auto mode the target temperature control is not available
+          // Instead, AC expects temperature offset in range [-3;+3] C
+          // AUTO HEATING: FFFD -> FFFF, FFFE -> FF00, FFFF -> FF01, FF00 -> FF02, FF01 -> FF03, FF02 -> FF04, FF03
+          // -> FF05
+          // AUTO COOLING: FFFD -> FFFB, FFFE -> FFFC, FFFF -> FFFD, FF00 -> FFFE, FF01 -> FFFF, FF02 ->
+          // FF00, FF03 -> FF01
+          // Needs testing, it's not clear if offset makes any difference in real life
+          int8_t offset_temp = static_cast<int8_t>(target_temperature - 0xFF00);
+          int8_t adjusted_offset = offset_temp;
+          if (this->hlink_entity_status_.hlink_climate_mode() == HLINK_MODE_HEAT_AUTO) {
+            adjusted_offset = offset_temp - 2;
+          } else if (this->hlink_entity_status_.hlink_climate_mode() == HLINK_MODE_COOL_AUTO) {
+            adjusted_offset = offset_temp + 2;
+          }
+          this->hlink_entity_status_.set_target_temperature(
+              this->clamp_auto_temperature_(this->reference_temperature_ + adjusted_offset));
+        } else if (target_temperature >= PROTOCOL_TARGET_TEMP_MIN && target_temperature <= PROTOCOL_TARGET_TEMP_MAX) {
+          this->hlink_entity_status_.set_target_temperature(target_temperature);
+        } else {
+          this->hlink_entity_status_.set_target_temperature(NAN);
+        }
+      }
+      break;
+    case HlinkDecoder::CURRENT_INDOOR_TEMP: {
+      optional<uint16_t> current_temperature = response.p_value_as_uint16();
+      if (current_temperature.has_value()) {
+        this->hlink_entity_status_.set_current_temperature(static_cast<int16_t>(current_temperature.value()));
+      } else {
+        this->hlink_entity_status_.set_current_temperature({});
+      }
+      if (!this->history_.throttle_publishes) {
+        this->publish_temperature_sensors_();
+      }
+      break;
+    }
+    case HlinkDecoder::FAN_MODE: {
+      auto fan_mode = ClimateFanModeRegister::decode(response);
+      if (fan_mode.has_value()) {
+        this->hlink_entity_status_.set_fan_mode(fan_mode);
+      }
+      break;
+    }
+    case HlinkDecoder::SWING_MODE: {
+      auto swing_mode = ClimateSwingModeRegister::decode(response);
+      if (swing_mode.has_value()) {
+        this->hlink_entity_status_.set_swing_mode(swing_mode);
+      }
+      break;
+    }
+    case HlinkDecoder::LEAVE_HOME_STATUS:
+      this->hlink_entity_status_.set_leave_home_enabled(response.p_value.has_value() &&
+                                                        response.p_value.value().back() == HLINK_LEAVE_HOME_ENABLED);
+      break;
+    case HlinkDecoder::ACTIVITY_STATUS:
+      if (this->hlink_entity_status_.hlink_climate_mode().has_value() &&
+          this->hlink_entity_status_.power_state().has_value()) {
+        auto is_powered_on = this->hlink_entity_status_.power_state().value();
+        auto is_active = response.p_value_as_uint16() == HLINK_ACTIVE_ON;
+        auto hlink_climate_mode = this->hlink_entity_status_.hlink_climate_mode().value();
+        if (!is_powered_on) {
+          this->hlink_entity_status_.set_action(esphome::climate::ClimateAction::CLIMATE_ACTION_OFF);
+        } else if (is_active && (hlink_climate_mode == HLINK_MODE_COOL || hlink_climate_mode == HLINK_MODE_COOL_AUTO)) {
+          this->hlink_entity_status_.set_action(esphome::climate::ClimateAction::CLIMATE_ACTION_COOLING);
+        } else if (is_active && (hlink_climate_mode == HLINK_MODE_HEAT || hlink_climate_mode == HLINK_MODE_HEAT_AUTO)) {
+          this->hlink_entity_status_.set_action(esphome::climate::ClimateAction::CLIMATE_ACTION_HEATING);
+        } else if (is_active && hlink_climate_mode == HLINK_MODE_DRY) {
+          this->hlink_entity_status_.set_action(esphome::climate::ClimateAction::CLIMATE_ACTION_DRYING);
+        } else if (hlink_climate_mode == HLINK_MODE_FAN) {
+          // Activity status is always 0x0000 in fan mode
+          this->hlink_entity_status_.set_action(esphome::climate::ClimateAction::CLIMATE_ACTION_FAN);
+        } else {
+          this->hlink_entity_status_.set_action(esphome::climate::ClimateAction::CLIMATE_ACTION_IDLE);
+        }
+      }
+      break;
+#ifdef USE_SENSOR
+    case HlinkDecoder::CURRENT_OUTDOOR_TEMP: {
+      optional<int8_t> raw_sensor_value = response.p_value_as_int8();
+      if (raw_sensor_value.has_value() && raw_sensor_value != 0x7E) {
+        this->hlink_entity_status_.set_outdoor_temperature(raw_sensor_value);
+      } else {
+        this->hlink_entity_status_.set_outdoor_temperature({});
+      }
+      if (!this->history_.throttle_publishes) {
+        this->publish_temperature_sensors_();
+      }
+      break;
+    }
+#endif
+#ifdef USE_BINARY_SENSOR
+    case HlinkDecoder::AIR_FILTER_WARNING: {
+      optional<int8_t> raw_sensor_value = response.p_value_as_int8();
+      if (raw_sensor_value.has_value() && this->air_filter_warning_binary_sensor_ != nullptr) {
+        HLINK_ALLOCATION_EXCLUDED();
+        this->air_filter_warning_binary_sensor_->publish_state(raw_sensor_value.value() != 0);
+      }
+      break;
+    }
+#endif
+#ifdef USE_SWITCH
+    case HlinkDecoder::REMOTE_CONTROL_LOCK: {
+      auto remote_control_lock = response.p_value_as_uint16();
+      if (remote_control_lock.has_value()) {
+        this->hlink_entity_status_.set_remote_control_lock(static_cast<bool>(remote_control_lock.value()));
+      } else {
+        this->hlink_entity_status_.set_remote_control_lock({});
+      }
+      break;
+    }
+#endif
+#ifdef USE_TEXT_SENSOR
+    case HlinkDecoder::MODEL_NAME:
+      if (response.p_value.has_value() && this->model_name_text_sensor_ != nullptr) {
+        const std::string &model_name = this->model_name_text_sensor_->state;
+        const char *value = reinterpret_cast<const char *>(response.p_value->begin());
+        // The model name is polled on every cycle, it's kept only by the text sensor and published once changed
+        if (model_name.size() != response.p_value->size() ||
+            model_name.compare(0, model_name.size(), value, response.p_value->size()) != 0) {
+          this->model_name_text_sensor_->publish_state(std::string(value, response.p_value->size()));
+        }
+      }
+      break;
+    case HlinkDecoder::DEBUG_TEXT_SENSOR: {
+      if (!response.p_value.has_value() || subscriber.entity_index >= this->debug_text_sensors_.size()) {
+        break;
+      }
+      DebugTextSensorState &debug_sensor = this->debug_text_sensors_[subscriber.entity_index];
+      if (debug_sensor.sensor == nullptr ||
+          (debug_sensor.has_value && debug_sensor.last_value == response.p_value.value())) {
+        break;
+      }
+      debug_sensor.last_value = response.p_value.value();
+      debug_sensor.has_value = true;
+      debug_sensor.sensor->publish_state(response.p_value_as_string().value());
+      break;
+    }
+#endif
+    case HlinkDecoder::ALARM_CODE: {
+      optional<uint16_t> alarm_code = response.p_value_as_uint16();
+      if (!alarm_code.has_value() || (this->hlink_entity_status_.alarm_code().has_value() &&
+                                      this->hlink_entity_status_.alarm_code().value() == alarm_code.value())) {
+        break;
+      }
+      this->hlink_entity_status_.set_alarm_code(alarm_code);
+      this->publish_alarm_code_(alarm_code.value());
+      break;
+    }
+    case HlinkDecoder::CUSTOM_REGISTER: {
+      if (subscriber.entity_index >= this->custom_registers_.size()) {
+        break;
+      }
+      HlinkCustomRegister &custom_register = this->custom_registers_[subscriber.entity_index];
+      optional<float> value = custom_register.decode(response);
+      if (!value.has_value()) {
+        break;
+      }
+#ifdef USE_SENSOR
+      this->update_sensor_state_(custom_register.sensor, value.value());
+#endif
+#ifdef USE_NUMBER
+      if (custom_register.number != nullptr && !is_nanable_equal_(custom_register.number->state, value.value())) {
+        HLINK_ALLOCATION_EXCLUDED();
+        custom_register.number->publish_state(value.value());
+      }
+#endif
+      break;
+    }
+    default:
+      break;
+  }
+}
+
+HlinkCustomRegister &HlinkAc::get_custom_register_(uint8_t index) {
+  if (index >= this->custom_registers_.size()) {
+    this->custom_registers_.resize(index + 1);
+  }
+  return this->custom_registers_[index];
+}
+
+void HlinkAc::set_custom_register(uint8_t index, uint16_t address, CustomRegisterType type, uint16_t bitmask,
+                                  float scale, float offset) {
+  HlinkCustomRegister &custom_register = this->get_custom_register_(index);
+  custom_register.address = address;
+  custom_register.type = type;
+  custom_register.bitmask = bitmask;
+  custom_register.scale = scale;
+  custom_register.offset = offset;
+}
+
+#ifdef USE_SENSOR
+void HlinkAc::set_custom_register_sensor(uint8_t index, sensor::Sensor *sens) {
+  this->get_custom_register_(index).sensor = sens;
+}
+#endif
+
+#ifdef USE_NUMBER
+void HlinkAc::set_custom_register_number(uint8_t index, number::Number *num) {
+  this->get_custom_register_(index).number = num;
+}
+
+void HlinkAc::write_custom_register(uint8_t index, float value) {
+  HlinkCustomRegister &custom_register = this->get_custom_register_(index);
+  auto publish_current_state = [this, index]() {
+    number::Number *num = this->custom_registers_[index].number;
+    num->publish_state(num->state);
+  };
+  optional<HlinkRequestFrame> frame = custom_register.encode(value);
+  if (!frame.has_value()) {
+    ESP_LOGW(TAG, "Can't write bitfield of %04X before the register is read", custom_register.address);
+    publish_current_state();
+    return;
+  }
+  this->enqueue_request_(
+      frame.value(),
+      [this, index, value](const HlinkResponseFrame &response) {
+        // Bitfield writes are based on the raw value, it's refreshed by the next poll
+        this->custom_registers_[index].number->publish_state(value);
+      },
+      publish_current_state, publish_current_state, publish_current_state);
+}
+#endif
+
+HlinkRequest HlinkAc::create_polling_request_(int16_t feature_index) {
+  return {{HlinkRequestFrame::Type::MT, {this->read_polling_descriptor_(feature_index).address}},
+          [this, feature_index](const HlinkResponseFrame &response) {
+            HlinkPollingFeature &feature = this->status_.polling_features[feature_index];
+            HlinkPollingDescriptor descriptor = this->read_polling_descriptor_(feature_index);
+            feature.consecutive_ng_count = 0;
+            if (feature.unsupported) {
+              ESP_LOGI(TAG, "Address %04X responded again, returning it to polling", descriptor.address);
+              feature.unsupported = false;
+              this->save_capabilities_();
+            }
+            for (uint8_t i = 0; i < descriptor.subscriber_count; i++) {
+              this->decode_polling_response_(this->read_polling_subscriber_(descriptor.first_subscriber + i),
+                                             response);
+            }
+          },
+          [this, feature_index]() { this->handle_polling_feature_ng_(feature_index); },
+          [this, feature_index]() { this->handle_polling_feature_no_answer_(feature_index); },
+          [this, feature_index]() { this->handle_polling_feature_no_answer_(feature_index); }};
+}
+
+int16_t HlinkAc::next_polling_feature_index_(int16_t from_index) {
+  uint32_t now = millis();
+  for (int16_t i = from_index; i < this->status_.polling_features_count; i++) {
+    if (this->passive_mode_ && this->is_sniffed_by_other_master_(this->status_.polling_features[i], now)) {
+      continue;
+    }
+    HlinkPollingDescriptor descriptor = this->read_polling_descriptor_(i);
+    if (this->status_.polling_features[i].should_poll(now, this->status_.completed_polling_cycles,
+                                                       this->is_polling_feature_informative_(descriptor),
+                                                       descriptor.poll_interval_ms)) {
+      return i;
+    }
+  }
+  return -1;
+}
+
+void HlinkAc::handle_polling_feature_ng_(int16_t feature_index) {
+  HlinkPollingFeature &feature = this->status_.polling_features[feature_index];
+  uint16_t address = this->read_polling_descriptor_(feature_index).address;
+  if (feature.unsupported) {
+    // Rare re-check failed, the unit still doesn't support it
+    feature.next_support_check_at_ms = millis() + UNSUPPORTED_FEATURE_RECHECK_INTERVAL;
+    return;
+  }
+  if (is_essential_polling_feature(address)) {
+    return;
+  }
+  feature.consecutive_ng_count++;
+  if (feature.consecutive_ng_count >= UNSUPPORTED_FEATURE_NG_THRESHOLD) {
+    ESP_LOGW(TAG, "Address %04X returned NG %u times in a row, excluding it from polling", address,
+             feature.consecutive_ng_count);
+    feature.unsupported = true;
+    feature.next_support_check_at_ms = millis() + UNSUPPORTED_FEATURE_RECHECK_INTERVAL;
+    this->save_capabilities_();
+  }
+}
+
+// A re-check that times out or gets an invalid answer proves nothing either way, it's repeated at the next interval
+void HlinkAc::handle_polling_feature_no_answer_(int16_t feature_index) {
+  HlinkPollingFeature &feature = this->status_.polling_features[feature_index];
+  if (feature.unsupported) {
+    feature.next_support_check_at_ms = millis() + UNSUPPORTED_FEATURE_RECHECK_INTERVAL;
+  }
+}
+
+void HlinkAc::load_capabilities_() {
+  constexpr uint32_t capabilities_version = 0x3C1A9B29;
+  this->capabilities_rtc_ = this->make_entity_preference<HlinkCapabilities>(capabilities_version);
+  HlinkCapabilities capabilities{};
+  if (!this->capabilities_rtc_.load(&capabilities)) {
+    return;
+  }
+  uint32_t next_check_at_ms = millis() + UNSUPPORTED_FEATURE_RECHECK_INTERVAL;
+  for (uint8_t i = 0; i < capabilities.unsupported_count && i < MAX_PERSISTED_UNSUPPORTED_FEATURES; i++) {
+    for (int16_t feature_index = 0; feature_index < this->status_.polling_features_count; feature_index++) {
+      uint16_t address = this->read_polling_descriptor_(feature_index).address;
+      if (!is_essential_polling_feature(address) && address == capabilities.unsupported_addresses[i]) {
+        ESP_LOGI(TAG, "Address %04X is known to be unsupported, excluding it from polling", address);
+        this->status_.polling_features[feature_index].unsupported = true;
+        this->status_.polling_features[feature_index].next_support_check_at_ms = next_check_at_ms;
+      }
+    }
+  }
+}
+
+void HlinkAc::save_capabilities_() {
+  HlinkCapabilities capabilities{};
+  for (int16_t i = 0; i < this->status_.polling_features_count; i++) {
+    if (this->status_.polling_features[i].unsupported &&
+        capabilities.unsupported_count < MAX_PERSISTED_UNSUPPORTED_FEATURES) {
+      capabilities.unsupported_addresses[capabilities.unsupported_count++] = this->read_polling_descriptor_(i).address;
+    }
+  }
+  if (!this->capabilities_rtc_.save(&capabilities)) {
+    ESP_LOGW(TAG, "Failed to save unsupported features");
+  }
+}
+
 void HlinkAc::request_status_update_() {
+  if (this->passive_mode_ &&
+      (!this->passive_poll_unseen_features_ || millis() <= this->passive_learning_period_ms_)) {
+    // Passive instances poll only the addresses the other master doesn't read, and only once those are learned
+    return;
+  }
   if (this->status_.state == IDLE) {
     // Launch update sequence
+    int16_t first_feature_index = this->next_polling_feature_index_(0);
+    if (first_feature_index < 0) {
+      this->status_.state = PUBLISH_UPDATE_IF_ANY;
+      this->status_.last_status_polling_finished_at_ms = millis();
+      this->status_.completed_polling_cycles++;
+      return;
+    }
     this->status_.state = REQUEST_NEXT_STATUS_FEATURE;
-    this->status_.requested_feature_index = 0;
-    this->status_.refresh_non_idle_timeout(this->status_.polling_features.size() * 500);
+    this->status_.requested_feature_index = first_feature_index;
+    this->status_.last_status_polling_started_at_ms = millis();
+    this->status_.refresh_non_idle_timeout(FRAME_WATCHDOG_TIMEOUT);
   }
 }
 
@@ -230,7 +700,7 @@ void HlinkAc::request_status_update_() {
  * Main loop implements a state machine with the following states:
  * 1. IDLE - does nothing.
  * 2. REQUEST_NEXT_STATUS_FEATURE - sends a request for the next status feature; the list of requested features is
- *    stored in the polling_features list.
+ *    stored in the polling table generated from the configuration.
  * 3. REQUEST_LOW_PRIORITY_FEATURE - sends a request for the low-priority feature, if any.
  * 4. READ_FEATURE_RESPONSE - reads a response for the requested hlink feature.
  * 5. PUBLISH_UPDATE_IF_ANY - once all features are read, updates components if there are any changes.
@@ -238,63 +708,110 @@ void HlinkAc::request_status_update_() {
  * 7. ACK_APPLIED_REQUEST - confirms successfully applied control request.
  */
 void HlinkAc::loop() {
-  if (this->status_.state == REQUEST_NEXT_STATUS_FEATURE && this->status_.can_send_next_frame()) {
-    HlinkRequest state_feature_request = this->status_.get_currently_polling_feature();
-    this->status_.current_request = make_unique<HlinkRequest>(state_feature_request);
-    this->write_hlink_frame_(state_feature_request.request_frame);
+  {
+    HLINK_ALLOCATION_SCOPE();
+    this->run_state_machine_();
+  }
+#ifdef HLINK_AC_ALLOCATION_ACCOUNTING
+  // Includes the allocations of control() calls since the previous loop()
+  uint32_t allocations = HlinkAllocationScope::allocations();
+  this->allocation_stats_.add_loop(allocations - this->allocation_stats_.last_counter);
+  this->allocation_stats_.last_counter = allocations;
+#endif
+}
+
+void HlinkAc::run_state_machine_() {
+  // Rolled back from the loop, a request rejected by a full queue fails inside control() before the provisional
+  // state is assigned
+  if (this->provisional_state_failed_ && this->provisional_requests_ == 0) {
+    this->rollback_provisional_state_();
+  }
+
+  // Bytes received while no response is awaited belong to another device on the bus
+  if (this->status_.state != READ_FEATURE_RESPONSE && this->status_.state != ACK_APPLIED_REQUEST) {
+    this->sniff_bus_();
+  }
+
+  if (this->status_.state == REQUEST_NEXT_STATUS_FEATURE && this->can_send_next_frame_()) {
+    this->send_frame_(this->read_polling_descriptor_(this->status_.requested_feature_index).frame);
+    this->status_.polling_features[this->status_.requested_feature_index].mark_polled(
+        millis(), this->status_.completed_polling_cycles);
+    this->status_.current_request = this->create_polling_request_(this->status_.requested_feature_index);
+    this->status_.has_current_request = true;
     this->status_.state = READ_FEATURE_RESPONSE;
     return;
   }
 
-  if (this->status_.state == REQUEST_LOW_PRIORITY_FEATURE && this->status_.can_send_next_frame()) {
+  if (this->status_.state == REQUEST_LOW_PRIORITY_FEATURE && this->can_send_next_frame_()) {
+#ifdef HLINK_AC_RAW_COMMANDS
+    // A running command batch goes ahead of debug discovery, which keeps its request in the slot meanwhile
+    this->answer_cmd_batch_from_cache_();
+    if (this->cmd_batch_.has_unsent_commands()) {
+      this->status_.current_request = this->create_cmd_batch_request_();
+      this->status_.has_current_request = true;
+      this->write_hlink_frame_(this->status_.current_request.request_frame);
+      this->status_.state = READ_FEATURE_RESPONSE;
+      return;
+    }
+#endif
     if (this->status_.low_priority_hlink_request.has_value()) {
-      HlinkRequest low_priority_feature_request = this->status_.low_priority_hlink_request.value();
-      this->write_hlink_frame_(low_priority_feature_request.request_frame);
-      this->status_.current_request = make_unique<HlinkRequest>(low_priority_feature_request);
+      this->status_.current_request = std::move(this->status_.low_priority_hlink_request.value());
+      this->status_.has_current_request = true;
       this->status_.low_priority_hlink_request = {};
+      this->write_hlink_frame_(this->status_.current_request.request_frame);
       this->status_.state = READ_FEATURE_RESPONSE;
       return;
     }
+    // The rest of the batch was answered from the read cache
+    this->status_.state = IDLE;
   }
 
   if (this->status_.state == READ_FEATURE_RESPONSE) {
     HlinkResponseFrame response = this->read_hlink_frame_();
-    if (this->status_.current_request == nullptr) {
+    if (!this->status_.has_current_request) {
       ESP_LOGW(TAG, "Received response for unknown feature");
       this->status_.reset_state();
       return;
     }
-    HlinkRequest requested_feature = *this->status_.current_request;
+    const HlinkRequest &requested_feature = this->status_.current_request;
     if (this->handle_hlink_request_response_(requested_feature, response)) {
-      if (this->status_.requested_feature_index == -1) {
-        // Requested feature index is -1 means that we are handling low priority request
-        this->status_.state = IDLE;
-      } else if (this->status_.requested_feature_index + 1 < this->status_.polling_features.size()) {
-        this->status_.state = REQUEST_NEXT_STATUS_FEATURE;
-        this->status_.requested_feature_index++;
-      } else {
-        this->status_.state = PUBLISH_UPDATE_IF_ANY;
-        this->status_.requested_feature_index = -1;
-        this->status_.last_status_polling_finished_at_ms = millis();
-      }
-      this->status_.current_request = nullptr;
+      this->finish_polling_request_();
+    } else if (response.status == HlinkResponseFrame::Status::COLLISION) {
+      // The request is read again on the next cycle, the sniffer holds the next frame until the bus is quiet
+      ESP_LOGW(TAG, "Dropping [MT - %04X] after a collision with another bus master",
+               requested_feature.request_frame.p.address);
+      this->time_out_request_(requested_feature);
+      this->finish_polling_request_();
+    } else if (this->status_.reached_frame_timeout()) {
+      // Give up on this frame only, the rest of the polling cycle goes on
+      ESP_LOGW(TAG, "No response for [MT - %04X] within %lu ms", requested_feature.request_frame.p.address,
+               this->status_.response_times.frame_timeout_ms);
+      this->status_.record_frame_timeout();
+      this->time_out_request_(requested_feature);
+      this->finish_polling_request_();
     }
   }
 
   if (this->status_.state == PUBLISH_UPDATE_IF_ANY) {
     this->publish_updates_if_any_();
+    this->update_status_statistics_();
     this->status_.state = IDLE;
     return;
   }
 
-  if (this->status_.state == APPLY_REQUEST && this->status_.can_send_next_frame()) {
+  if (this->status_.state == APPLY_REQUEST && this->can_send_next_frame_()) {
+    if (this->status_.has_current_request) {
+      // Request wasn't acknowledged, resend it once its backoff has passed
+      if (this->status_.can_retry_request()) {
+        this->apply_current_request_();
+      }
+      return;
+    }
     if (this->status_.requests_left_to_apply > 0) {
-      std::unique_ptr<HlinkRequest> request_msg = this->pending_action_requests_.dequeue();
-      if (request_msg != nullptr) {
-        this->write_hlink_frame_(request_msg->request_frame);
-        this->status_.current_request = std::move(request_msg);
+      if (this->pending_action_requests_.dequeue(this->status_.current_request)) {
+        this->status_.has_current_request = true;
         this->status_.requests_left_to_apply--;
-        this->status_.state = ACK_APPLIED_REQUEST;
+        this->apply_current_request_();
         return;
       } else {
         this->status_.state = IDLE;
@@ -306,13 +823,23 @@ void HlinkAc::loop() {
 
   if (this->status_.state == ACK_APPLIED_REQUEST) {
     HlinkResponseFrame response = this->read_hlink_frame_();
-    if (this->handle_hlink_request_response_(*this->status_.current_request, response)) {
+    uint32_t acked_at_ms = millis();
+    if (this->handle_hlink_request_response_(this->status_.current_request, response)) {
+      if (response.status == HlinkResponseFrame::Status::OK) {
+        this->record_control_latency_(this->status_.current_request, acked_at_ms);
+      }
       if (this->status_.requests_left_to_apply > 0) {
         this->status_.state = APPLY_REQUEST;
       } else {
         this->status_.state = IDLE;
       }
-      this->status_.current_request = nullptr;
+      this->status_.has_current_request = false;
+    } else if (response.status == HlinkResponseFrame::Status::COLLISION) {
+      // Retried after a back-off, the same way as an unanswered request
+      this->handle_request_ack_timeout_();
+    } else if (this->status_.reached_frame_timeout()) {
+      this->status_.record_frame_timeout();
+      this->handle_request_ack_timeout_();
     }
     // Update status right away after the applied batch
     if (this->status_.state == IDLE) {
@@ -339,26 +866,24 @@ void HlinkAc::loop() {
              this->status_.timeout_counter_started_at_ms, this->status_.requests_left_to_apply,
              this->pending_action_requests_.size(),
              this->status_.low_priority_hlink_request.has_value() ? "YES" : "NO");
-    if (this->status_.current_request != nullptr) {
-      ESP_LOGW(TAG, "Request time out: [%s - %04X,%s]",
-               this->status_.current_request->request_frame.type == HlinkRequestFrame::Type::MT ? "MT" : "ST",
-               this->status_.current_request->request_frame.p.address,
-               this->status_.current_request->request_frame.p.data.has_value()
-                   ? esphome::format_hex_pretty(this->status_.current_request->request_frame.p.data.value()).c_str()
+    if (this->status_.has_current_request) {
+      const HlinkRequestFrame &frame = this->status_.current_request.request_frame;
+      ESP_LOGW(TAG, "Request time out: [%s - %04X,%s]", frame.type == HlinkRequestFrame::Type::MT ? "MT" : "ST",
+               frame.p.address,
+               frame.p.data.has_value()
+                   ? esphome::format_hex_pretty(frame.p.data->begin(), frame.p.data->size()).c_str()
                    : "none");
-      auto timeout_callback = this->status_.current_request->timeout_callback;
-      if (timeout_callback != nullptr) {
-        timeout_callback();
+      this->time_out_request_(this->status_.current_request);
+      if (this->status_.state == APPLY_REQUEST || this->status_.state == ACK_APPLIED_REQUEST) {
+        this->dropped_requests_++;
+        this->publish_request_counters_();
       }
     }
     if (this->status_.state == READ_FEATURE_RESPONSE || this->status_.state == ACK_APPLIED_REQUEST) {
       ESP_LOGW(TAG, "RX buffer: %s, read size: %d", this->status_.hlink_response_buffer.c_str(),
                this->status_.hlink_response_buffer_index);
     }
-    // Reset pending requests queue to avoid the infinite loop
-    while (!this->pending_action_requests_.is_empty()) {
-      this->pending_action_requests_.dequeue();
-    }
+    // Only the request in flight is dropped, pending requests are applied right after the reset
     this->status_.reset_state();
   }
 
@@ -375,7 +900,7 @@ void HlinkAc::loop() {
 #endif
     this->status_.requests_left_to_apply = this->pending_action_requests_.size();
     this->status_.state = APPLY_REQUEST;
-    this->status_.refresh_non_idle_timeout(2000);
+    this->status_.refresh_non_idle_timeout(FRAME_WATCHDOG_TIMEOUT);
   }
 
   // Start polling cycle if we are in IDLE state and the status update interval is reached
@@ -383,20 +908,244 @@ void HlinkAc::loop() {
     this->request_status_update_();
   }
 
+#if defined(USE_TEXT_SENSOR) && defined(HLINK_AC_DEBUG_DISCOVERY)
+  if (this->debug_discovery_batch_count_ > 0 &&
+      millis() - this->debug_discovery_batch_started_at_ms_ > this->debug_discovery_batch_interval_ms_) {
+    this->flush_debug_discovery_results_();
+  }
+#endif
+
   // Request low priority feature if idling and nothing else to do
-  if (this->status_.state == IDLE && this->status_.low_priority_hlink_request.has_value()) {
+  bool has_low_priority_request = this->status_.low_priority_hlink_request.has_value();
+#ifdef HLINK_AC_RAW_COMMANDS
+  has_low_priority_request = has_low_priority_request || this->cmd_batch_.has_unsent_commands();
+#endif
+  if (this->status_.state == IDLE && has_low_priority_request) {
     this->status_.state = REQUEST_LOW_PRIORITY_FEATURE;
-    this->status_.refresh_non_idle_timeout(300);
+    this->status_.refresh_non_idle_timeout(FRAME_WATCHDOG_TIMEOUT);
   }
 }
 
+void HlinkAc::finish_polling_request_() {
+  if (this->status_.requested_feature_index == -1) {
+    // Requested feature index is -1 means that we are handling low priority request
+    this->status_.state = IDLE;
+  } else {
+    // Unsupported features are skipped until their re-check is due
+    int16_t next_feature_index = this->next_polling_feature_index_(this->status_.requested_feature_index + 1);
+    if (next_feature_index != -1) {
+      this->status_.state = REQUEST_NEXT_STATUS_FEATURE;
+      this->status_.requested_feature_index = next_feature_index;
+    } else {
+      this->status_.state = PUBLISH_UPDATE_IF_ANY;
+      this->status_.requested_feature_index = -1;
+      this->status_.last_status_polling_finished_at_ms = millis();
+      this->status_.completed_polling_cycles++;
+      this->status_.last_polling_cycle_ms =
+          this->status_.last_status_polling_finished_at_ms - this->status_.last_status_polling_started_at_ms;
+    }
+  }
+  this->status_.has_current_request = false;
+}
+
+void HlinkAc::apply_current_request_() {
+  if (this->status_.current_request.attempts == 0) {
+    this->status_.current_request.sent_at_ms = millis();
+  }
+  this->write_hlink_frame_(this->status_.current_request.request_frame);
+  this->status_.current_request.attempts++;
+  this->status_.state = ACK_APPLIED_REQUEST;
+}
+
+void HlinkAc::handle_request_ack_timeout_() {
+  HlinkRequest &request = this->status_.current_request;
+  const char *request_type = request.request_frame.type == HlinkRequestFrame::Type::MT ? "MT" : "ST";
+  if (request.attempts <= MAX_REQUEST_RETRIES) {
+    uint32_t backoff_ms = REQUEST_RETRY_BACKOFF << (request.attempts - 1);
+    ESP_LOGW(TAG, "No response for [%s - %04X], retrying in %lu ms (attempt %u of %u)", request_type,
+             request.request_frame.p.address, backoff_ms, request.attempts + 1, MAX_REQUEST_RETRIES + 1);
+    this->status_.retry_request_at_ms = millis() + backoff_ms;
+    this->status_.refresh_non_idle_timeout(backoff_ms + FRAME_WATCHDOG_TIMEOUT);
+    this->status_.state = APPLY_REQUEST;
+    this->retried_requests_++;
+    this->publish_request_counters_();
+    return;
+  }
+  ESP_LOGW(TAG, "No response for [%s - %04X] after %u attempts, dropping it", request_type,
+           request.request_frame.p.address, request.attempts);
+  this->time_out_request_(request);
+  this->status_.has_current_request = false;
+  this->status_.state = this->status_.requests_left_to_apply > 0 ? APPLY_REQUEST : IDLE;
+  this->dropped_requests_++;
+  this->publish_request_counters_();
+}
+
+void HlinkAc::publish_request_counters_() {
+#ifdef USE_SENSOR
+  this->update_sensor_state_(this->request_retries_sensor_, this->retried_requests_);
+  this->update_sensor_state_(this->dropped_requests_sensor_, this->dropped_requests_);
+#endif
+}
+
+void HlinkAc::publish_temperature_sensors_() {
+#ifdef USE_SENSOR
+  this->update_sensor_state_(this->indoor_temperature_sensor_,
+                             this->hlink_entity_status_.current_temperature().value_or(NAN));
+  optional<int8_t> outdoor_temperature = this->hlink_entity_status_.outdoor_temperature();
+  this->update_sensor_state_(this->outdoor_temperature_sensor_,
+                             outdoor_temperature.has_value() ? outdoor_temperature.value() : NAN);
+#endif
+}
+
+void HlinkAc::update_status_statistics_() {
+  if (this->history_.is_sample_due(millis())) {
+    this->record_history_sample_();
+  }
+#ifdef USE_SENSOR
+  if (this->duty_cycle_ != nullptr) {
+    this->update_duty_cycle_();
+  }
+#endif
+}
+
+void HlinkAc::record_history_sample_() {
+  const HlinkEntityStatus &status = this->hlink_entity_status_;
+  int8_t indoor_temperature = HLINK_HISTORY_NO_TEMPERATURE;
+  float current_temperature = status.current_temperature().value_or(NAN);
+  if (!std::isnan(current_temperature)) {
+    indoor_temperature = static_cast<int8_t>(current_temperature);
+  }
+  int8_t outdoor_temperature = status.outdoor_temperature().value_or(HLINK_HISTORY_NO_TEMPERATURE);
+  optional<climate::ClimateAction> action = status.action();
+  uint8_t flags =
+      action.has_value() ? static_cast<uint8_t>(action.value()) & HLINK_HISTORY_ACTION_MASK : HLINK_HISTORY_NO_ACTION;
+  optional<bool> power_state = status.power_state();
+  if (power_state.has_value()) {
+    flags |= HLINK_HISTORY_POWER_KNOWN | (power_state.value() ? HLINK_HISTORY_POWER_ON : 0);
+  }
+  this->history_.add(indoor_temperature, outdoor_temperature, flags, millis());
+  if (this->history_.throttle_publishes) {
+    this->publish_temperature_sensors_();
+  }
+}
+
+void HlinkAc::export_history(uint16_t max_samples) {
+  uint16_t count = this->history_.count;
+  if (max_samples > 0 && max_samples < count) {
+    count = max_samples;
+  }
+  // Newest sample age first, then walk back to the oldest exported one
+  uint32_t age_s = count > 0 ? (millis() - this->history_.last_sample_at_ms) / 1000 : 0;
+  for (uint16_t i = 0; i + 1 < count; i++) {
+    age_s += this->history_.newest(i).delta_s;
+  }
+  std::string result = "age_s,indoor,outdoor,power,action";
+  result.reserve(result.size() + count * 24);
+  for (uint16_t i = count; i > 0; i--) {
+    const HlinkHistorySample &sample = this->history_.newest(i - 1);
+    char line[48];
+    char indoor[5] = "";
+    char outdoor[5] = "";
+    if (sample.indoor_temperature != HLINK_HISTORY_NO_TEMPERATURE) {
+      snprintf(indoor, sizeof(indoor), "%d", sample.indoor_temperature);
+    }
+    if (sample.outdoor_temperature != HLINK_HISTORY_NO_TEMPERATURE) {
+      snprintf(outdoor, sizeof(outdoor), "%d", sample.outdoor_temperature);
+    }
+    uint8_t action = sample.flags & HLINK_HISTORY_ACTION_MASK;
+    snprintf(line, sizeof(line), ";%lu,%s,%s,%s,%s", static_cast<unsigned long>(age_s), indoor, outdoor,
+             !(sample.flags & HLINK_HISTORY_POWER_KNOWN) ? ""
+             : sample.flags & HLINK_HISTORY_POWER_ON     ? "1"
+                                                         : "0",
+             action == HLINK_HISTORY_NO_ACTION
+                 ? ""
+                 : LOG_STR_ARG(climate::climate_action_to_string(static_cast<climate::ClimateAction>(action))));
+    result += line;
+    if (i > 1) {
+      age_s -= this->history_.newest(i - 2).delta_s;
+    }
+  }
+  this->history_export_callback_.call(result);
+}
+
+void HlinkAc::add_history_export_callback(std::function<void(const std::string &)> &&callback) {
+  this->history_export_callback_.add(std::move(callback));
+}
+
+void HlinkAc::publish_alarm_code_(uint16_t alarm_code) {
+  HLINK_ALLOCATION_EXCLUDED();
+  if (alarm_code != HLINK_NO_ALARM) {
+    ESP_LOGW(TAG, "Unit reports alarm code %04X", alarm_code);
+  }
+#ifdef USE_BINARY_SENSOR
+  if (this->fault_binary_sensor_ != nullptr) {
+    this->fault_binary_sensor_->publish_state(alarm_code != HLINK_NO_ALARM);
+  }
+#endif
+#ifdef USE_TEXT_SENSOR
+  if (this->alarm_text_sensor_ == nullptr) {
+    return;
+  }
+  if (alarm_code == HLINK_NO_ALARM) {
+    this->alarm_text_sensor_->publish_state("No alarm");
+    return;
+  }
+  for (uint8_t i = 0; i < this->alarm_codes_count_; i++) {
+    if (progmem_read_struct(&this->alarm_codes_[i].code) == alarm_code) {
+      HlinkAlarmCode entry = progmem_read_struct(&this->alarm_codes_[i]);
+      this->alarm_text_sensor_->publish_state(entry.description);
+      return;
+    }
+  }
+  char unknown_alarm[24];
+  snprintf(unknown_alarm, sizeof(unknown_alarm), "Unknown alarm %04X", alarm_code);
+  this->alarm_text_sensor_->publish_state(unknown_alarm);
+#endif
+}
+
+void HlinkAc::record_control_latency_(const HlinkRequest &request, uint32_t acked_at_ms) {
+  uint32_t now = millis();
+  this->control_latency_.queued.add_sample(request.sent_at_ms - request.enqueued_at_ms);
+  this->control_latency_.bus.add_sample(acked_at_ms - request.sent_at_ms);
+  this->control_latency_.publish.add_sample(now - acked_at_ms);
+  this->control_latency_.end_to_end.add_sample(now - request.enqueued_at_ms);
+#ifdef USE_SENSOR
+  const HlinkLatencyStats &end_to_end = this->control_latency_.end_to_end;
+  this->update_sensor_state_(this->control_latency_last_sensor_, end_to_end.last_ms);
+  this->update_sensor_state_(this->control_latency_average_sensor_, end_to_end.average_ms());
+  this->update_sensor_state_(this->control_latency_max_sensor_, end_to_end.max_ms);
+#endif
+}
+
+void HlinkAc::log_latency_stats_(const char *stage, const HlinkLatencyStats &stats) const {
+  char histogram[CONTROL_LATENCY_BUCKETS * 16];
+  size_t length = 0;
+  for (uint8_t i = 0; i < CONTROL_LATENCY_BUCKETS && length < sizeof(histogram); i++) {
+    if (i < CONTROL_LATENCY_BUCKETS - 1) {
+      length += snprintf(histogram + length, sizeof(histogram) - length, " <=%u:%u", CONTROL_LATENCY_BUCKET_EDGES_MS[i],
+                         stats.buckets[i]);
+    } else {
+      length += snprintf(histogram + length, sizeof(histogram) - length, " >%u:%u",
+                         CONTROL_LATENCY_BUCKET_EDGES_MS[i - 1], stats.buckets[i]);
+    }
+  }
+  ESP_LOGCONFIG(TAG, "    %s: last %lu ms, avg %lu ms, max %lu ms, buckets%s", stage, stats.last_ms, stats.average_ms(),
+                stats.max_ms, histogram);
+}
+
 bool HlinkAc::handle_hlink_request_response_(const HlinkRequest &request, const HlinkResponseFrame &response) {
   if (response.status == HlinkResponseFrame::Status::NOTHING ||
-      response.status == HlinkResponseFrame::Status::PARTIAL) {
+      response.status == HlinkResponseFrame::Status::PARTIAL ||
+      response.status == HlinkResponseFrame::Status::COLLISION) {
     return false;
   }
   switch (response.status) {
     case HlinkResponseFrame::Status::OK:
+#ifdef HLINK_AC_RAW_COMMANDS
+      if (request.request_frame.type == HlinkRequestFrame::Type::MT && response.p_value.has_value()) {
+        this->status_.read_cache.store(request.request_frame.p.address, response.p_value.value(), millis());
+      }
+#endif
       if (request.ok_callback != nullptr) {
         request.ok_callback(response);
       }
@@ -420,52 +1169,87 @@ bool HlinkAc::handle_hlink_request_response_(const HlinkRequest &request, const
     default:
       break;
   }
+  if (request.provisional) {
+    this->finish_provisional_request_(response.status == HlinkResponseFrame::Status::OK);
+  }
   return true;
 }
 
-void HlinkAc::publish_updates_if_any_() {
-  if (this->hlink_entity_status_.has_minimal_hvac_status()) {
+void HlinkAc::notify_status_changes_() {
+  HLINK_ALLOCATION_EXCLUDED();
+  uint16_t changed_fields = this->hlink_entity_status_.commit_changes();
+  if (changed_fields != 0) {
+    this->status_change_callback_.call(this->hlink_entity_status_, changed_fields);
+  }
+}
+
+void HlinkAc::add_on_status_change_callback(
+    std::function<void(const HlinkEntityStatus &status, uint16_t changed_fields)> &&callback) {
+  this->status_change_callback_.add(std::move(callback));
+}
+
+bool HlinkAc::publish_updates_if_any_() {
+  HlinkEntityStatus &status = this->hlink_entity_status_;
+  bool climate_state_published = false;
+  // Polled values may predate the provisional state, it's reconciled once all its writes are answered
+  if (this->provisional_requests_ == 0 && status.has_minimal_hvac_status() &&
+      status.is_pending_publish(HLINK_STATUS_CLIMATE_FIELDS)) {
+    if (status.is_pending_publish(HLINK_STATUS_POWER_STATE | HLINK_STATUS_MODE) &&
+        status.mode() == esphome::climate::ClimateMode::CLIMATE_MODE_OFF) {
+      status.set_target_temperature(NAN);
+    }
+    // Activity status is polled less often while it's uninformative, so derive the obvious actions right away
+    if (status.is_pending_publish(HLINK_STATUS_POWER_STATE | HLINK_STATUS_HLINK_CLIMATE_MODE | HLINK_STATUS_ACTION) &&
+        status.action().has_value()) {
+      if (!status.power_state().value()) {
+        status.set_action(esphome::climate::ClimateAction::CLIMATE_ACTION_OFF);
+      } else if (status.hlink_climate_mode() == HLINK_MODE_FAN) {
+        status.set_action(esphome::climate::ClimateAction::CLIMATE_ACTION_FAN);
+      }
+    }
+    // Only the dirty fields are compared, control callbacks may have published the same values already
+    uint16_t dirty = status.take_pending_publish(HLINK_STATUS_CLIMATE_FIELDS);
     bool should_publish_climate_state = false;
     // Mode
-    if (this->mode != this->hlink_entity_status_.mode.value()) {
-      this->mode = this->hlink_entity_status_.mode.value();
-      if (this->mode == esphome::climate::ClimateMode::CLIMATE_MODE_OFF) {
-        this->hlink_entity_status_.target_temperature = NAN;
-      }
+    if ((dirty & HLINK_STATUS_MODE) && this->mode != status.mode().value()) {
+      this->mode = status.mode().value();
       should_publish_climate_state = true;
     }
     // Target Temp
-    if (!is_nanable_equal_(this->target_temperature, this->hlink_entity_status_.target_temperature.value())) {
-      this->target_temperature = this->hlink_entity_status_.target_temperature.value();
+    if ((dirty & HLINK_STATUS_TARGET_TEMPERATURE) &&
+        !is_nanable_equal_(this->target_temperature, status.target_temperature().value())) {
+      this->target_temperature = status.target_temperature().value();
       should_publish_climate_state = true;
     }
     // Current Temp
-    if (this->current_temperature != this->hlink_entity_status_.current_temperature.value()) {
-      this->current_temperature = this->hlink_entity_status_.current_temperature.value();
+    if ((dirty & HLINK_STATUS_CURRENT_TEMPERATURE) &&
+        !is_nanable_equal_(this->current_temperature, status.current_temperature().value())) {
+      this->current_temperature = status.current_temperature().value();
       should_publish_climate_state = true;
     }
     // Fan Mode
-    if (this->hlink_entity_status_.fan_mode.has_value() &&
-        this->fan_mode != this->hlink_entity_status_.fan_mode.value()) {
-      this->fan_mode = this->hlink_entity_status_.fan_mode.value();
+    if ((dirty & HLINK_STATUS_FAN_MODE) && status.fan_mode().has_value() &&
+        this->fan_mode != status.fan_mode().value()) {
+      this->fan_mode = status.fan_mode().value();
       should_publish_climate_state = true;
     }
     // Swing Mode
-    if (this->hlink_entity_status_.swing_mode.has_value() &&
-        this->swing_mode != this->hlink_entity_status_.swing_mode.value()) {
-      this->swing_mode = this->hlink_entity_status_.swing_mode.value();
+    if ((dirty & HLINK_STATUS_SWING_MODE) && status.swing_mode().has_value() &&
+        this->swing_mode != status.swing_mode().value()) {
+      this->swing_mode = status.swing_mode().value();
       should_publish_climate_state = true;
     }
     // HVAC Action (actively heating, cooling, etc.)
-    if (this->hlink_entity_status_.action.has_value() && this->hlink_entity_status_.action.value() != this->action) {
-      this->action = this->hlink_entity_status_.action.value();
+    if (this->support_hvac_actions_ && (dirty & HLINK_STATUS_ACTION) && status.action().has_value() &&
+        status.action().value() != this->action) {
+      this->action = status.action().value();
       should_publish_climate_state = true;
     }
-    // Leave home mode
-    if (this->hlink_entity_status_.leave_home_enabled.has_value()) {
+    // Leave home mode, derived from the power state and the target temperature as well
+    if ((dirty & (HLINK_STATUS_LEAVE_HOME | HLINK_STATUS_POWER_STATE | HLINK_STATUS_TARGET_TEMPERATURE)) &&
+        status.leave_home_enabled().has_value()) {
       esphome::climate::ClimatePreset climate_preset = esphome::climate::ClimatePreset::CLIMATE_PRESET_NONE;
-      if (this->hlink_entity_status_.leave_home_enabled.value() && this->hlink_entity_status_.power_state.value() &&
-          this->hlink_entity_status_.target_temperature == 10) {
+      if (status.leave_home_enabled().value() && status.power_state().value() && status.target_temperature() == 10) {
         climate_preset = esphome::climate::ClimatePreset::CLIMATE_PRESET_AWAY;
       }
       if (this->preset != climate_preset) {
@@ -474,40 +1258,37 @@ void HlinkAc::publish_updates_if_any_() {
       }
     }
     if (should_publish_climate_state) {
-      this->publish_state();
+      this->publish_climate_state_();
+      climate_state_published = true;
     }
   }
 #ifdef USE_SWITCH
-  if (this->remote_lock_switch_ != nullptr && this->hlink_entity_status_.remote_control_lock.has_value() &&
-      this->remote_lock_switch_->state != this->hlink_entity_status_.remote_control_lock.value()) {
-    this->remote_lock_switch_->publish_state(this->hlink_entity_status_.remote_control_lock.value());
-  }
-#endif
-#ifdef USE_TEXT_SENSOR
-  if (this->model_name_text_sensor_ != nullptr && this->hlink_entity_status_.model_name.has_value() &&
-      this->model_name_text_sensor_->state != this->hlink_entity_status_.model_name.value()) {
-    this->model_name_text_sensor_->publish_state(this->hlink_entity_status_.model_name.value());
+  if (status.take_pending_publish(HLINK_STATUS_REMOTE_CONTROL_LOCK) != 0 && this->remote_lock_switch_ != nullptr &&
+      status.remote_control_lock().has_value() &&
+      this->remote_lock_switch_->state != status.remote_control_lock().value()) {
+    HLINK_ALLOCATION_EXCLUDED();
+    this->remote_lock_switch_->publish_state(status.remote_control_lock().value());
   }
 #endif
+  this->notify_status_changes_();
+  return climate_state_published;
 }
 
-void HlinkAc::write_hlink_frame_(HlinkRequestFrame frame) {
-  // Reset uart buffer before sending new frame
-  if (this->available()) {
-    ESP_LOGW(TAG,
-             "UART RX buffer is not empty before sending H-link frame. Normally this shouldn't happen. Flushing it.");
-    while (this->available()) {
-      this->read();
-    }
-  }
-  this->status_.reset_response_buffer();
+void HlinkAc::publish_climate_state_() {
+  HLINK_ALLOCATION_EXCLUDED();
+  this->publish_state();
+}
 
+void HlinkAc::write_hlink_frame_(const HlinkRequestFrame &frame) {
   const char *message_type = frame.type == HlinkRequestFrame::Type::MT ? "MT" : "ST";
-  uint8_t message_size = 17;  // Default message, e.g. "MT P=1234 C=1234\r"
-  if (frame.p.data.has_value()) {
-    message_size += frame.p.data.value().size() * 2 + 1;  // "ST P=1234,12345.. C=1234\r" +1 for comma
+#ifdef HLINK_AC_RAW_COMMANDS
+  if (frame.type == HlinkRequestFrame::Type::ST) {
+    // The written value isn't known until the address is read back
+    this->status_.read_cache.invalidate(frame.p.address);
   }
-  std::string message(message_size, 0x00);
+#endif
+  // "ST P=1234,12345.. C=1234\r", formatted on the stack
+  char message[HLINK_MSG_WRITE_BUFFER_SIZE];
   uint16_t checksum = 0xFFFF - (frame.p.address >> 8) - (frame.p.address & 0xFF);
   if (frame.p.data.has_value()) {
     for (const auto &byte : frame.p.data.value()) {
@@ -515,19 +1296,28 @@ void HlinkAc::write_hlink_frame_(HlinkRequestFrame frame) {
     }
   }
   if (frame.p.data.has_value()) {
-    char p_data_string[frame.p.data.value().size() * 2 + 1];
+    char p_data_string[HLINK_MAX_REQUEST_PAYLOAD_SIZE * 2 + 1];
     char *p_data_ptr_iterator = p_data_string;
     for (const uint8_t &byte : frame.p.data.value()) {
       sprintf(p_data_ptr_iterator, "%02X", byte);
       p_data_ptr_iterator += 2;
     }
     *p_data_ptr_iterator = '\0';
-    sprintf(&message[0], "%s P=%04X,%s C=%04X\r", message_type, frame.p.address, p_data_string, checksum);
+    snprintf(message, sizeof(message), "%s P=%04X,%s C=%04X\r", message_type, frame.p.address, p_data_string,
+             checksum);
   } else {
-    sprintf(&message[0], "%s P=%04X C=%04X\r", message_type, frame.p.address, checksum);
+    snprintf(message, sizeof(message), "%s P=%04X C=%04X\r", message_type, frame.p.address, checksum);
   }
+  this->send_frame_(message);
+}
+
+void HlinkAc::send_frame_(const char *message) {
+  // Bytes of other devices are consumed by the sniffer, which keeps us from sending until the bus is quiet
+  this->status_.reset_response_buffer();
   // Send the message to uart
-  this->write_str(message.c_str());
+  this->write_str(message);
+  this->status_.frame_sent_at_ms = millis();
+  this->status_.refresh_non_idle_timeout(FRAME_WATCHDOG_TIMEOUT);
 }
 
 // Returns PARTIAL state if the response is not finished yet
@@ -570,47 +1360,68 @@ HlinkResponseFrame HlinkAc::read_hlink_frame_() {
     return HLINK_RESPONSE_PARTIAL;
   }
 
+  if (response_buf.compare(0, 2, "MT") == 0 || response_buf.compare(0, 2, "ST") == 0) {
+    // A request of another master collided with ours. The unit answers it next and the answer carries no address,
+    // so the exchange has failed. The sniffer attributes the answer to the other master's request.
+    ESP_LOGW(TAG, "Received a request of another bus master while waiting for a response: %s", response_buf.c_str());
+    this->handle_sniffed_frame_(&response_buf[0], read_index + 1);
+    this->status_.reset_response_buffer();
+    return HLINK_RESPONSE_COLLISION;
+  }
+
   // Update the timestamp of the last successfully received frame
   this->status_.last_frame_received_at_ms = millis();
-  std::vector<std::string> response_tokens;
-  for (int i = 0, last_space_i = 0; i <= read_index; i++) {
-    if (response_buf[i] == ' ' || response_buf[i] == '\r') {
-      uint8_t pos_shift = last_space_i > 0 ? 2 : 0;  // Shift ahead to remove 'X=' from the tokens after initial OK/NG
-      response_tokens.push_back(response_buf.substr(last_space_i + pos_shift, i - last_space_i - pos_shift));
-      last_space_i = i + 1;
-    }
-  }
-  if (response_tokens.size() == 1 && response_tokens[0] == HLINK_MSG_OK_TOKEN) {
+  this->status_.response_times.add_sample(this->status_.last_frame_received_at_ms - this->status_.frame_sent_at_ms);
+  return this->parse_hlink_response_(&response_buf[0], read_index + 1);
+}
+
+// Parses "OK\r", "OK P=XXXX C=YYYY\r" and "NG P=XXXX C=YYYY\r" frames in place, the length includes the CR
+HlinkResponseFrame HlinkAc::parse_hlink_response_(const char *frame, uint8_t length) {
+  if (length == 3 && strncmp(frame, "OK\r", 3) == 0) {
     // ACK frame
     return HLINK_RESPONSE_ACK_OK;
   }
-  if (response_tokens.size() != 3) {
-    ESP_LOGW(TAG, "Invalid response: %s", response_buf.c_str());
+  const char *frame_end = frame + length - 1;
+  const char *value_start = frame + 5;
+  const char *checksum_start = value_start;
+  while (checksum_start < frame_end && *checksum_start != ' ') {
+    checksum_start++;
+  }
+  if (length < 5 || frame[2] != ' ' || strncmp(frame + 3, "P=", 2) != 0 || frame_end - checksum_start != 7 ||
+      strncmp(checksum_start, " C=", 3) != 0) {
+    ESP_LOGW(TAG, "Invalid response: %.*s", length, frame);
     return HLINK_RESPONSE_INVALID;
   }
 
   HlinkResponseFrame::Status status;
-  if (response_tokens[0] == HLINK_MSG_OK_TOKEN) {
+  if (strncmp(frame, "OK", 2) == 0) {
     status = HlinkResponseFrame::Status::OK;
-  } else if (response_tokens[0] == HLINK_MSG_NG_TOKEN) {
+  } else if (strncmp(frame, "NG", 2) == 0) {
     status = HlinkResponseFrame::Status::NG;
   } else {
-    ESP_LOGW(TAG, "Unexpected token in response: [%s]. Response tokens array size: %d", response_tokens[0].c_str(),
-             response_tokens.size());
-    for (int i = 0; i < response_tokens.size(); i++) {
-      ESP_LOGW(TAG, "Token %d: %s", i, response_tokens[i].c_str());
-    }
+    ESP_LOGW(TAG, "Unexpected token in response: [%.*s]", length, frame);
     return HLINK_RESPONSE_INVALID;
   }
-  if (response_tokens[1].size() < 2 || response_tokens[1].size() % 2 != 0) {
-    ESP_LOGW(TAG, "Invalid length for P= value: %s", response_tokens[1].c_str());
+  size_t value_length = checksum_start - value_start;
+  if (value_length < 2 || value_length % 2 != 0 || value_length / 2 > HLINK_MAX_RESPONSE_PAYLOAD_SIZE) {
+    ESP_LOGW(TAG, "Invalid length for P= value: %.*s", static_cast<int>(value_length), value_start);
     return HLINK_RESPONSE_INVALID;
   }
-  std::vector<uint8_t> p_value;
-  for (size_t i = 0; i < response_tokens[1].size(); i += 2) {
-    p_value.push_back(static_cast<uint8_t>(std::stoi(response_tokens[1].substr(i, 2), nullptr, 16)));
+  HlinkResponsePayload p_value;
+  for (const char *hex = value_start; hex < checksum_start; hex += 2) {
+    uint8_t byte;
+    if (!parse_hex_byte(hex, byte)) {
+      ESP_LOGW(TAG, "Invalid P= value: %.*s", static_cast<int>(value_length), value_start);
+      return HLINK_RESPONSE_INVALID;
+    }
+    p_value.push_back(byte);
+  }
+  uint8_t checksum_high, checksum_low;
+  if (!parse_hex_byte(checksum_start + 3, checksum_high) || !parse_hex_byte(checksum_start + 5, checksum_low)) {
+    ESP_LOGW(TAG, "Invalid checksum in the response frame: %.*s", length, frame);
+    return HLINK_RESPONSE_INVALID;
   }
-  uint16_t checksum = std::stoi(response_tokens[2], nullptr, 16);
+  uint16_t checksum = (checksum_high << 8) | checksum_low;
   // Validate checksum
   uint16_t calculated_checksum = 0xFFFF;
   for (size_t i = 0; i < p_value.size(); i++) {
@@ -623,12 +1434,192 @@ HlinkResponseFrame HlinkAc::read_hlink_frame_() {
   return {status, p_value, checksum};
 }
 
+bool HlinkAc::is_sniffed_by_other_master_(const HlinkPollingFeature &feature, uint32_t now) const {
+  return feature.last_sniffed_at_ms != 0 && now - feature.last_sniffed_at_ms < this->passive_learning_period_ms_;
+}
+
+void HlinkAc::sniff_bus_() {
+  auto &sniffer = this->sniffer_;
+  if (sniffer.length > 0 && millis() - sniffer.last_byte_at_ms > DEFAULT_FRAME_TIMEOUT) {
+    // The rest of the frame never came
+    sniffer.length = 0;
+    sniffer.noise_frames++;
+  }
+  while (this->available()) {
+    uint8_t byte;
+    if (!this->read_byte(&byte)) {
+      return;
+    }
+    sniffer.last_byte_at_ms = millis();
+    if (sniffer.length >= HLINK_MSG_READ_BUFFER_SIZE) {
+      ESP_LOGW(TAG, "Sniffed frame is longer than %d bytes, dropping it", HLINK_MSG_READ_BUFFER_SIZE);
+      sniffer.length = 0;
+      sniffer.noise_frames++;
+    }
+    sniffer.buffer[sniffer.length++] = byte;
+    if (byte == ASCII_CR) {
+      this->handle_sniffed_frame_(sniffer.buffer, sniffer.length);
+      sniffer.length = 0;
+    }
+  }
+}
+
+// Parses "MT P=XXXX C=YYYY" and "ST P=XXXX,DATA C=YYYY" frames sent by another master
+optional<HlinkRequestFrame> HlinkAc::parse_hlink_request_(const char *frame, uint8_t length) {
+  if (length < 17 || frame[length - 1] != ASCII_CR || (frame[0] != 'M' && frame[0] != 'S') || frame[1] != 'T' ||
+      strncmp(frame + 2, " P=", 3) != 0) {
+    return {};
+  }
+  bool is_read = frame[0] == 'M';
+  // " C=YYYY\r" closes the frame
+  const char *checksum_start = frame + length - 8;
+  uint8_t address_high, address_low, checksum_high, checksum_low;
+  if (strncmp(checksum_start, " C=", 3) != 0 || !parse_hex_byte(frame + 5, address_high) ||
+      !parse_hex_byte(frame + 7, address_low) || !parse_hex_byte(checksum_start + 3, checksum_high) ||
+      !parse_hex_byte(checksum_start + 5, checksum_low)) {
+    return {};
+  }
+  HlinkRequestFrame request{is_read ? HlinkRequestFrame::Type::MT : HlinkRequestFrame::Type::ST,
+                            {static_cast<uint16_t>((address_high << 8) | address_low)}};
+  const char *data_start = frame + 9;
+  if (is_read != (data_start == checksum_start)) {
+    return {};
+  }
+  if (!is_read) {
+    if (*data_start != ',' || (checksum_start - data_start - 1) < 2 || (checksum_start - data_start - 1) % 2 != 0) {
+      return {};
+    }
+    HlinkRequestPayload payload;
+    for (const char *hex = data_start + 1; hex < checksum_start; hex += 2) {
+      uint8_t byte;
+      if (!parse_hex_byte(hex, byte) || !payload.push_back(byte)) {
+        return {};
+      }
+    }
+    request.p.data = payload;
+  }
+  uint16_t calculated_checksum = 0xFFFF - address_high - address_low;
+  if (request.p.data.has_value()) {
+    for (uint8_t byte : request.p.data.value()) {
+      calculated_checksum -= byte;
+    }
+  }
+  if (calculated_checksum != ((checksum_high << 8) | checksum_low)) {
+    return {};
+  }
+  return request;
+}
+
+bool HlinkAc::is_bus_quiet_() {
+  const auto &sniffer = this->sniffer_;
+  uint32_t now = millis();
+  if (sniffer.length > 0) {
+    // Another device is in the middle of a frame
+    return false;
+  }
+  if (sniffer.pending_request.has_value() && now - sniffer.pending_request_at_ms < DEFAULT_FRAME_TIMEOUT) {
+    // The unit is about to answer a request of another master
+    return false;
+  }
+  return sniffer.last_byte_at_ms == 0 || now - sniffer.last_byte_at_ms > BUS_QUIET_WINDOW;
+}
+
+bool HlinkAc::can_send_next_frame_() {
+  if (!this->status_.can_send_next_frame()) {
+    return false;
+  }
+  if (this->is_bus_quiet_()) {
+    return true;
+  }
+  // Waiting for another device to finish isn't a stuck state
+  this->status_.refresh_non_idle_timeout(FRAME_WATCHDOG_TIMEOUT);
+  return false;
+}
+
+void HlinkAc::record_contention_event_() {
+  this->contention_events_++;
+#ifdef USE_SENSOR
+  this->update_sensor_state_(this->bus_contention_sensor_, this->contention_events_);
+#endif
+}
+
+void HlinkAc::handle_sniffed_frame_(const char *frame, uint8_t length) {
+  auto &sniffer = this->sniffer_;
+  bool is_response = length >= 3 && (strncmp(frame, "OK", 2) == 0 || strncmp(frame, "NG", 2) == 0);
+  optional<HlinkRequestFrame> request = is_response ? optional<HlinkRequestFrame>{}
+                                                    : this->parse_hlink_request_(frame, length);
+  if (!is_response && !request.has_value()) {
+    ESP_LOGD(TAG, "Unrecognized bytes on the bus: %s",
+             format_hex_pretty(reinterpret_cast<const uint8_t *>(frame), length).c_str());
+    sniffer.noise_frames++;
+    return;
+  }
+  if (is_response && (!sniffer.pending_request.has_value() ||
+                      millis() - sniffer.pending_request_at_ms > DEFAULT_FRAME_TIMEOUT)) {
+    // Not an answer to another master, most likely a late answer to our own request that already timed out
+    ESP_LOGD(TAG, "Response without a pending request of another master: %.*s", length - 1, frame);
+    sniffer.pending_request = {};
+    return;
+  }
+  sniffer.foreign_frames++;
+  // Traffic of another master is contention only when it delays or interrupts an exchange of our own
+  if (this->status_.state != IDLE) {
+    this->record_contention_event_();
+  }
+  if (request.has_value()) {
+    sniffer.pending_request = request;
+    sniffer.pending_request_at_ms = millis();
+    return;
+  }
+  HlinkRequestFrame sniffed_request = sniffer.pending_request.value();
+  sniffer.pending_request = {};
+  if (!this->passive_mode_) {
+    return;
+  }
+  HlinkResponseFrame response = this->parse_hlink_response_(frame, length);
+  if (response.status != HlinkResponseFrame::Status::OK) {
+    return;
+  }
+  uint16_t address = sniffed_request.p.address;
+  if (sniffed_request.type == HlinkRequestFrame::Type::ST) {
+#ifdef HLINK_AC_RAW_COMMANDS
+    this->status_.read_cache.invalidate(address);
+#endif
+    return;
+  }
+  if (!response.p_value.has_value()) {
+    return;
+  }
+  uint32_t now = millis();
+#ifdef HLINK_AC_RAW_COMMANDS
+  this->status_.read_cache.store(address, response.p_value.value(), now);
+#endif
+  for (int16_t i = 0; i < this->status_.polling_features_count; i++) {
+    HlinkPollingDescriptor descriptor = this->read_polling_descriptor_(i);
+    if (descriptor.address != address) {
+      continue;
+    }
+    this->status_.polling_features[i].last_sniffed_at_ms = now;
+    for (uint8_t j = 0; j < descriptor.subscriber_count; j++) {
+      this->decode_polling_response_(this->read_polling_subscriber_(descriptor.first_subscriber + j), response);
+    }
+    sniffer.decoded_responses++;
+    this->publish_updates_if_any_();
+    this->update_status_statistics_();
+    return;
+  }
+}
+
 void HlinkAc::reset_air_filter_clean_warning() {
   this->enqueue_request_(
       HlinkRequestFrame::with_uint8(HlinkRequestFrame::Type::ST, FeatureType::CLEAN_FILTER_WARNING_RESET, 0x01));
 }
 
-void HlinkAc::send_hlink_cmd(std::string cmd_type, std::string address, optional<std::string> data) {
+#ifdef HLINK_AC_RAW_COMMANDS
+void HlinkAc::set_read_cache_ttl(uint32_t ttl_ms) { this->status_.read_cache.set_ttl(ttl_ms); }
+
+void HlinkAc::send_hlink_cmd(std::string cmd_type, std::string address, optional<std::string> data,
+                             bool force_read) {
   if (address.size() != 4) {
     ESP_LOGW(TAG, "Invalid address length: %s", address.c_str());
     return;
@@ -659,6 +1650,15 @@ void HlinkAc::send_hlink_cmd(std::string cmd_type, std::string address, optional
     ESP_LOGD(TAG, "Timeout while applying a custom request [%s:%s]", cmd_type.c_str(), address.c_str());
     this->send_hlink_cmd_result_callback_.call({TIMEOUT, cmd_type, address, data, {}});
   };
+  if (cmd_type == "MT" && !force_read) {
+    optional<std::string> cached_value =
+        this->status_.read_cache.get_fresh_value(static_cast<uint16_t>(std::stoi(address, nullptr, 16)), millis());
+    if (cached_value.has_value()) {
+      ESP_LOGD(TAG, "Custom request [MT:%s] answered from the read cache", address.c_str());
+      this->send_hlink_cmd_result_callback_.call({HLINK_MSG_OK_TOKEN, cmd_type, address, data, cached_value});
+      return;
+    }
+  }
   if (cmd_type == "MT") {
     this->enqueue_request_({HlinkRequestFrame::Type::MT, {static_cast<uint16_t>(std::stoi(address, nullptr, 16))}},
                            ok_callback, ng_callback, timeout_callback);
@@ -674,78 +1674,179 @@ void HlinkAc::add_send_hlink_cmd_result_callback(std::function<void(const SendHl
   this->send_hlink_cmd_result_callback_.add(std::move(callback));
 }
 
+void HlinkAc::send_hlink_cmd_batch(const std::string &commands, optional<uint16_t> start_address,
+                                   optional<uint16_t> end_address, bool json_result, bool force_read) {
+  if (this->cmd_batch_.is_running()) {
+    ESP_LOGW(TAG, "H-link command batch is already running, new batch is ignored");
+    return;
+  }
+  std::vector<HlinkRequestFrame> batch;
+  size_t position = 0;
+  while (position < commands.size()) {
+    size_t token_end = commands.find_first_of(" ,;\n", position);
+    if (token_end == std::string::npos) {
+      token_end = commands.size();
+    }
+    std::string token = commands.substr(position, token_end - position);
+    position = token_end + 1;
+    if (token.empty()) {
+      continue;
+    }
+    size_t separator = token.find('=');
+    std::string address = token.substr(0, separator);
+    std::string data = separator == std::string::npos ? "" : token.substr(separator + 1);
+    if (address.size() != 4 || !is_hex_string(address) || !is_hex_string(data) || data.size() % 2 != 0 ||
+        (separator != std::string::npos && data.empty())) {
+      ESP_LOGW(TAG, "Invalid H-link batch command: %s", token.c_str());
+      return;
+    }
+    uint16_t p_address = static_cast<uint16_t>(std::stoi(address, nullptr, 16));
+    if (data.empty()) {
+      batch.push_back({HlinkRequestFrame::Type::MT, {p_address}});
+    } else {
+      batch.push_back(HlinkRequestFrame::with_string(HlinkRequestFrame::Type::ST, p_address, data));
+    }
+  }
+  if (start_address.has_value() != end_address.has_value() ||
+      (start_address.has_value() && start_address.value() > end_address.value())) {
+    ESP_LOGW(TAG, "Invalid H-link batch address range");
+    return;
+  }
+  size_t range_size = start_address.has_value() ? end_address.value() - start_address.value() + 1 : 0;
+  if (batch.size() + range_size == 0 || batch.size() + range_size > MAX_HLINK_CMD_BATCH_SIZE) {
+    ESP_LOGW(TAG, "H-link command batch should have 1 to %u commands", MAX_HLINK_CMD_BATCH_SIZE);
+    return;
+  }
+  for (size_t i = 0; i < range_size; i++) {
+    batch.push_back({HlinkRequestFrame::Type::MT, {static_cast<uint16_t>(start_address.value() + i)}});
+  }
+  auto &cmd_batch = this->cmd_batch_;
+  cmd_batch.commands = std::move(batch);
+  cmd_batch.next_command = 0;
+  cmd_batch.completed_commands = 0;
+  cmd_batch.json_result = json_result;
+  cmd_batch.force_read = force_read;
+  // Longest compact entry is "XXXX:TIMEOUT "
+  cmd_batch.result.clear();
+  cmd_batch.result.reserve(cmd_batch.commands.size() * 16 + 2);
+  if (json_result) {
+    cmd_batch.result += '{';
+  }
+  ESP_LOGD(TAG, "Started H-link command batch of %u commands", static_cast<unsigned>(cmd_batch.commands.size()));
+}
+
+void HlinkAc::add_send_hlink_cmd_batch_result_callback(std::function<void(const std::string &)> &&callback) {
+  this->send_hlink_cmd_batch_result_callback_.add(std::move(callback));
+}
+
+HlinkRequest HlinkAc::create_cmd_batch_request_() {
+  HlinkRequestFrame frame = this->cmd_batch_.commands[this->cmd_batch_.next_command++];
+  return HlinkRequest{frame,
+                      [this](const HlinkResponseFrame &response) {
+                        this->append_cmd_batch_result_(response.p_value_as_string().value_or(HLINK_MSG_OK_TOKEN));
+                      },
+                      [this]() { this->append_cmd_batch_result_(HLINK_MSG_NG_TOKEN); },
+                      [this]() { this->append_cmd_batch_result_("INVALID"); },
+                      [this]() { this->append_cmd_batch_result_(TIMEOUT); }};
+}
+
+void HlinkAc::answer_cmd_batch_from_cache_() {
+  auto &cmd_batch = this->cmd_batch_;
+  while (!cmd_batch.force_read && cmd_batch.has_unsent_commands()) {
+    const HlinkRequestFrame &frame = cmd_batch.commands[cmd_batch.next_command];
+    if (frame.type != HlinkRequestFrame::Type::MT) {
+      return;
+    }
+    optional<std::string> cached_value = this->status_.read_cache.get_fresh_value(frame.p.address, millis());
+    if (!cached_value.has_value()) {
+      return;
+    }
+    cmd_batch.next_command++;
+    this->append_cmd_batch_result_(cached_value.value());
+  }
+}
+
+// Commands are sent one at a time, so results arrive in the order of the batch
+void HlinkAc::append_cmd_batch_result_(const std::string &value) {
+  auto &cmd_batch = this->cmd_batch_;
+  if (!cmd_batch.is_running()) {
+    return;
+  }
+  char address[5];
+  sprintf(address, "%04X", cmd_batch.commands[cmd_batch.completed_commands].p.address);
+  if (cmd_batch.completed_commands > 0) {
+    cmd_batch.result += cmd_batch.json_result ? ',' : ' ';
+  }
+  if (cmd_batch.json_result) {
+    cmd_batch.result += '"';
+    cmd_batch.result += address;
+    cmd_batch.result += "\":\"";
+    cmd_batch.result += value;
+    cmd_batch.result += '"';
+  } else {
+    cmd_batch.result += address;
+    cmd_batch.result += ':';
+    cmd_batch.result += value;
+  }
+  if (++cmd_batch.completed_commands < cmd_batch.commands.size()) {
+    return;
+  }
+  if (cmd_batch.json_result) {
+    cmd_batch.result += '}';
+  }
+  std::string result = std::move(cmd_batch.result);
+  // Release the batch before the callbacks, so they are free to start the next one
+  cmd_batch = HlinkCmdBatch();
+  ESP_LOGD(TAG, "H-link command batch finished: %s", result.c_str());
+  this->send_hlink_cmd_batch_result_callback_.call(result);
+}
+#endif
+
 void HlinkAc::control(const esphome::climate::ClimateCall &call) {
+  HLINK_ALLOCATION_SCOPE();
+  // Later controls build on the pending provisional state, a rollback returns to the state before the first one
+  if (this->optimistic_ && this->provisional_requests_ == 0 && !this->provisional_state_failed_) {
+    this->provisional_snapshot_ = {this->mode, this->target_temperature, this->fan_mode, this->swing_mode,
+                                   this->preset};
+  }
   climate::ClimateMode requested_mode = call.get_mode().value_or(this->mode);
   if (call.get_mode().has_value()) {
     climate::ClimateMode mode = *call.get_mode();
-    uint16_t power_state = 0x0001;
-    uint16_t h_link_mode = HLINK_MODE_AUTO;
-    switch (mode) {
-      case climate::ClimateMode::CLIMATE_MODE_OFF:
-        power_state = 0x0000;
-        break;
-      case climate::ClimateMode::CLIMATE_MODE_COOL:
-        h_link_mode = HLINK_MODE_COOL;
-        break;
-      case climate::ClimateMode::CLIMATE_MODE_HEAT:
-        h_link_mode = HLINK_MODE_HEAT;
-        break;
-      case climate::ClimateMode::CLIMATE_MODE_DRY:
-        h_link_mode = HLINK_MODE_DRY;
-        break;
-      case climate::ClimateMode::CLIMATE_MODE_FAN_ONLY:
-        h_link_mode = HLINK_MODE_FAN;
-        break;
-      case climate::ClimateMode::CLIMATE_MODE_HEAT_COOL:
-        h_link_mode = HLINK_MODE_AUTO;
-        break;
-      default:
-        power_state = 0x0000;
-        break;
-    }
-    this->enqueue_request_(
+    // Modes without a protocol value (OFF or unsupported ones) turn the unit off
+    optional<uint16_t> h_link_mode = ClimateModeRegister::encode(mode);
+    uint16_t power_state = h_link_mode.has_value() ? 0x0001 : 0x0000;
+    this->enqueue_control_request_(
         HlinkRequestFrame::with_uint8(HlinkRequestFrame::Type::ST, FeatureType::POWER_STATE, power_state));
-    this->enqueue_request_(HlinkRequestFrame::with_uint16(HlinkRequestFrame::Type::ST, FeatureType::MODE, h_link_mode),
-                           [this, power_state, mode](const HlinkResponseFrame &response) {
-                             this->hlink_entity_status_.power_state = power_state;
-                             this->hlink_entity_status_.mode = mode;
-                             this->mode = mode;
-                             if (!power_state) {
-                               this->hlink_entity_status_.target_temperature = NAN;
-                               this->target_temperature = NAN;
-                             }
-                             this->publish_state();
-                           });
+    this->enqueue_control_request_(ClimateModeRegister::write_frame(h_link_mode.value_or(HLINK_MODE_AUTO)),
+                                   [this, power_state, mode](const HlinkResponseFrame &response) {
+                                     this->hlink_entity_status_.set_power_state(power_state);
+                                     this->hlink_entity_status_.set_mode(mode);
+                                     this->mode = mode;
+                                     if (!power_state) {
+                                       this->hlink_entity_status_.set_target_temperature(NAN);
+                                       this->target_temperature = NAN;
+                                     }
+                                     this->publish_climate_state_();
+                                   });
+    if (this->optimistic_) {
+      this->mode = mode;
+      if (!power_state) {
+        this->target_temperature = NAN;
+      }
+    }
   }
   if (call.get_fan_mode().has_value()) {
     climate::ClimateFanMode fan_mode = *call.get_fan_mode();
-    uint8_t h_link_fan_speed = HLINK_FAN_AUTO;
-    switch (fan_mode) {
-      case climate::ClimateFanMode::CLIMATE_FAN_AUTO:
-        h_link_fan_speed = HLINK_FAN_AUTO;
-        break;
-      case climate::ClimateFanMode::CLIMATE_FAN_HIGH:
-        h_link_fan_speed = HLINK_FAN_HIGH;
-        break;
-      case climate::ClimateFanMode::CLIMATE_FAN_MEDIUM:
-        h_link_fan_speed = HLINK_FAN_MEDIUM;
-        break;
-      case climate::ClimateFanMode::CLIMATE_FAN_LOW:
-        h_link_fan_speed = HLINK_FAN_LOW;
-        break;
-      case climate::ClimateFanMode::CLIMATE_FAN_QUIET:
-        h_link_fan_speed = HLINK_FAN_QUIET;
-        break;
-      default:
-        break;
-    }
-    this->enqueue_request_(
-        HlinkRequestFrame::with_uint8(HlinkRequestFrame::Type::ST, FeatureType::FAN_MODE, h_link_fan_speed),
+    this->enqueue_control_request_(
+        ClimateFanModeRegister::write_frame(ClimateFanModeRegister::encode(fan_mode).value_or(HLINK_FAN_AUTO)),
         [this, fan_mode](const HlinkResponseFrame &response) {
-          this->hlink_entity_status_.fan_mode = fan_mode;
+          this->hlink_entity_status_.set_fan_mode(fan_mode);
           this->fan_mode = fan_mode;
-          this->publish_state();
+          this->publish_climate_state_();
         });
+    if (this->optimistic_) {
+      this->fan_mode = fan_mode;
+    }
   }
   if (call.get_target_temperature().has_value()) {
     float target_temperature = call.get_target_temperature().value();
@@ -754,65 +1855,114 @@ void HlinkAc::control(const esphome::climate::ClimateCall &call) {
       target_temperature = this->clamp_auto_temperature_(target_temperature);
       hlink_target_temperature = this->encode_auto_temperature_(target_temperature);
     }
-    this->enqueue_request_(
+    this->enqueue_control_request_(
         HlinkRequestFrame::with_uint16(HlinkRequestFrame::Type::ST, FeatureType::TARGET_TEMP, hlink_target_temperature),
         [this, target_temperature](const HlinkResponseFrame &response) {
-          this->hlink_entity_status_.target_temperature = target_temperature;
+          this->hlink_entity_status_.set_target_temperature(target_temperature);
           this->target_temperature = target_temperature;
-          this->publish_state();
+          this->publish_climate_state_();
         });
+    if (this->optimistic_) {
+      this->target_temperature = target_temperature;
+    }
   }
   if (call.get_swing_mode().has_value()) {
     climate::ClimateSwingMode swing_mode = *call.get_swing_mode();
-    uint8_t h_link_swing_mode = HLINK_SWING_OFF;
-    switch (swing_mode) {
-      case climate::ClimateSwingMode::CLIMATE_SWING_OFF:
-        h_link_swing_mode = HLINK_SWING_OFF;
-        break;
-      case climate::ClimateSwingMode::CLIMATE_SWING_VERTICAL:
-        h_link_swing_mode = HLINK_SWING_VERTICAL;
-        break;
-      case climate::ClimateSwingMode::CLIMATE_SWING_HORIZONTAL:
-        h_link_swing_mode = HLINK_SWING_HORIZONTAL;
-        break;
-      case climate::ClimateSwingMode::CLIMATE_SWING_BOTH:
-        h_link_swing_mode = HLINK_SWING_BOTH;
-        break;
-    }
-    this->enqueue_request_(
-        HlinkRequestFrame::with_uint8(HlinkRequestFrame::Type::ST, FeatureType::SWING_MODE, h_link_swing_mode),
+    this->enqueue_control_request_(
+        ClimateSwingModeRegister::write_frame(ClimateSwingModeRegister::encode(swing_mode).value_or(HLINK_SWING_OFF)),
         [this, swing_mode](const HlinkResponseFrame &response) {
-          this->hlink_entity_status_.swing_mode = swing_mode;
+          this->hlink_entity_status_.set_swing_mode(swing_mode);
           this->swing_mode = swing_mode;
-          this->publish_state();
+          this->publish_climate_state_();
         });
+    if (this->optimistic_) {
+      this->swing_mode = swing_mode;
+    }
   }
   if (call.get_preset().has_value()) {
     climate::ClimatePreset preset = *call.get_preset();
     if (preset == climate::ClimatePreset::CLIMATE_PRESET_AWAY) {
-      this->enqueue_request_(
+      this->enqueue_control_request_(
           HlinkRequestFrame::with_uint16(HlinkRequestFrame::Type::ST, FeatureType::MODE, HLINK_MODE_HEAT));
-      this->enqueue_request_(HlinkRequestFrame::with_uint16(
-          HlinkRequestFrame::Type::ST, FeatureType::LEAVE_HOME_STATUS_WRITE, HLINK_ENABLE_LEAVE_HOME));
-      this->enqueue_request_(HlinkRequestFrame::with_uint8(HlinkRequestFrame::Type::ST, FeatureType::POWER_STATE, 0x01),
-                             [this](const HlinkResponseFrame &response) {
-                               this->hlink_entity_status_.power_state = true;
-                               this->hlink_entity_status_.hlink_climate_mode = HLINK_MODE_HEAT;
-                               this->hlink_entity_status_.mode = esphome::climate::ClimateMode::CLIMATE_MODE_HEAT;
-                               this->hlink_entity_status_.target_temperature = 10;
-                               this->hlink_entity_status_.leave_home_enabled = true;
-                               this->mode = this->hlink_entity_status_.mode.value();
-                               this->target_temperature = this->hlink_entity_status_.target_temperature.value();
-                               this->preset = esphome::climate::ClimatePreset::CLIMATE_PRESET_AWAY;
-                               this->publish_state();
-                             });
+      this->enqueue_control_request_(
+          HlinkRequestFrame::with_uint16(HlinkRequestFrame::Type::ST, FeatureType::LEAVE_HOME_STATUS_WRITE,
+                                         HLINK_ENABLE_LEAVE_HOME),
+          [this](const HlinkResponseFrame &response) { this->hlink_entity_status_.set_leave_home_enabled(true); });
+      this->enqueue_control_request_(
+          HlinkRequestFrame::with_uint8(HlinkRequestFrame::Type::ST, FeatureType::POWER_STATE, 0x01),
+          [this](const HlinkResponseFrame &response) {
+            this->hlink_entity_status_.set_power_state(true);
+            this->hlink_entity_status_.set_hlink_climate_mode(HLINK_MODE_HEAT);
+            this->hlink_entity_status_.set_mode(esphome::climate::ClimateMode::CLIMATE_MODE_HEAT);
+            this->hlink_entity_status_.set_target_temperature(10);
+            this->mode = this->hlink_entity_status_.mode().value();
+            this->target_temperature = this->hlink_entity_status_.target_temperature().value();
+            // Away only once its leave home write was acknowledged as well
+            if (this->hlink_entity_status_.leave_home_enabled().value_or(false)) {
+              this->preset = esphome::climate::ClimatePreset::CLIMATE_PRESET_AWAY;
+            }
+            this->publish_climate_state_();
+          });
+      if (this->optimistic_) {
+        this->mode = esphome::climate::ClimateMode::CLIMATE_MODE_HEAT;
+        this->target_temperature = 10;
+      }
     }
     if (preset == climate::ClimatePreset::CLIMATE_PRESET_NONE) {
-      this->enqueue_request_(HlinkRequestFrame::with_uint16(
+      this->enqueue_control_request_(HlinkRequestFrame::with_uint16(
           HlinkRequestFrame::Type::ST, FeatureType::LEAVE_HOME_STATUS_WRITE, HLINK_DISABLE_LEAVE_HOME));
-      this->enqueue_request_(
+      this->enqueue_control_request_(
           HlinkRequestFrame::with_uint8(HlinkRequestFrame::Type::ST, FeatureType::POWER_STATE, 0x01));
     }
+    if (this->optimistic_) {
+      this->preset = preset;
+    }
+  }
+  if (this->optimistic_ && this->provisional_requests_ > 0) {
+    this->publish_climate_state_();
+  }
+}
+
+void HlinkAc::enqueue_control_request_(HlinkRequestFrame request_frame,
+                                       std::function<void(const HlinkResponseFrame &response)> ok_callback) {
+  if (this->optimistic_) {
+    // Finished by the response handling or by the timeout paths, see time_out_request_()
+    this->provisional_requests_++;
+  }
+  this->enqueue_request_(request_frame, std::move(ok_callback), nullptr, nullptr, nullptr, this->optimistic_);
+}
+
+void HlinkAc::finish_provisional_request_(bool confirmed) {
+  if (this->provisional_requests_ > 0) {
+    this->provisional_requests_--;
+  }
+  if (!confirmed) {
+    this->provisional_state_failed_ = true;
+  }
+}
+
+void HlinkAc::time_out_request_(const HlinkRequest &request) {
+  if (request.timeout_callback != nullptr) {
+    request.timeout_callback();
+  }
+  if (request.provisional) {
+    this->finish_provisional_request_(false);
+  }
+}
+
+void HlinkAc::rollback_provisional_state_() {
+  ESP_LOGW(TAG, "Control request wasn't applied, rolling back to the state before the control");
+  this->provisional_state_failed_ = false;
+  const ProvisionalClimateSnapshot &snapshot = this->provisional_snapshot_;
+  this->mode = snapshot.mode;
+  this->target_temperature = snapshot.target_temperature;
+  this->fan_mode = snapshot.fan_mode;
+  this->swing_mode = snapshot.swing_mode;
+  this->preset = snapshot.preset;
+  // Fields confirmed or polled since the snapshot override it, unpolled ones like swing or preset keep it
+  this->hlink_entity_status_.mark_pending_publish(HLINK_STATUS_CLIMATE_FIELDS);
+  if (!this->publish_updates_if_any_()) {
+    this->publish_climate_state_();
   }
 }
 
@@ -823,21 +1973,6 @@ void HlinkAc::set_supported_climate_modes(esphome::climate::ClimateModeMask mode
 
 void HlinkAc::set_supported_swing_modes(esphome::climate::ClimateSwingModeMask modes) {
   this->traits_.set_supported_swing_modes(modes);
-  if (modes.size() == 1 && modes.count(climate::ClimateSwingMode::CLIMATE_SWING_OFF)) {
-    return;  // If the only supported swing mode is OFF, we don't need to add polling for swing mode status
-  }
-  this->status_.polling_features.push_back(
-      {{HlinkRequestFrame::Type::MT, {FeatureType::SWING_MODE}}, [this](const HlinkResponseFrame &response) {
-         if (response.p_value_as_uint16() == HLINK_SWING_OFF) {
-           this->hlink_entity_status_.swing_mode = esphome::climate::ClimateSwingMode::CLIMATE_SWING_OFF;
-         } else if (response.p_value_as_uint16() == HLINK_SWING_VERTICAL) {
-           this->hlink_entity_status_.swing_mode = esphome::climate::ClimateSwingMode::CLIMATE_SWING_VERTICAL;
-         } else if (response.p_value_as_uint16() == HLINK_SWING_HORIZONTAL) {
-           this->hlink_entity_status_.swing_mode = esphome::climate::ClimateSwingMode::CLIMATE_SWING_HORIZONTAL;
-         } else if (response.p_value_as_uint16() == HLINK_SWING_BOTH) {
-           this->hlink_entity_status_.swing_mode = esphome::climate::ClimateSwingMode::CLIMATE_SWING_BOTH;
-         }
-       }});
 }
 
 void HlinkAc::set_supported_fan_modes(esphome::climate::ClimateFanModeMask modes) {
@@ -849,44 +1984,12 @@ void HlinkAc::set_supported_climate_presets(esphome::climate::ClimatePresetMask
   if (!presets.empty()) {
     this->traits_.add_supported_preset(climate::ClimatePreset::CLIMATE_PRESET_NONE);
   }
-  if (presets.count(climate::ClimatePreset::CLIMATE_PRESET_AWAY)) {
-    this->status_.polling_features.push_back({{HlinkRequestFrame::Type::MT, {FeatureType::LEAVE_HOME_STATUS_READ}},
-                                              [this](const HlinkResponseFrame &response) {
-                                                this->hlink_entity_status_.leave_home_enabled =
-                                                    response.p_value.has_value() &&
-                                                    response.p_value.value().back() == HLINK_LEAVE_HOME_ENABLED;
-                                              }});
-  }
 }
 
 void HlinkAc::set_support_hvac_actions(bool support_hvac_actions) {
+  this->support_hvac_actions_ = support_hvac_actions;
   if (support_hvac_actions) {
     this->traits_.add_feature_flags(climate::CLIMATE_SUPPORTS_ACTION);
-    this->status_.polling_features.push_back(
-        {{HlinkRequestFrame::Type::MT, {FeatureType::ACTIVITY_STATUS}}, [this](const HlinkResponseFrame &response) {
-           if (this->hlink_entity_status_.hlink_climate_mode.has_value() &&
-               this->hlink_entity_status_.power_state.has_value()) {
-             auto is_powered_on = this->hlink_entity_status_.power_state.value();
-             auto is_active = response.p_value_as_uint16() == HLINK_ACTIVE_ON;
-             auto hlink_climate_mode = this->hlink_entity_status_.hlink_climate_mode.value();
-             if (!is_powered_on) {
-               this->hlink_entity_status_.action = esphome::climate::ClimateAction::CLIMATE_ACTION_OFF;
-             } else if (is_active &&
-                        (hlink_climate_mode == HLINK_MODE_COOL || hlink_climate_mode == HLINK_MODE_COOL_AUTO)) {
-               this->hlink_entity_status_.action = esphome::climate::ClimateAction::CLIMATE_ACTION_COOLING;
-             } else if (is_active &&
-                        (hlink_climate_mode == HLINK_MODE_HEAT || hlink_climate_mode == HLINK_MODE_HEAT_AUTO)) {
-               this->hlink_entity_status_.action = esphome::climate::ClimateAction::CLIMATE_ACTION_HEATING;
-             } else if (is_active && hlink_climate_mode == HLINK_MODE_DRY) {
-               this->hlink_entity_status_.action = esphome::climate::ClimateAction::CLIMATE_ACTION_DRYING;
-             } else if (hlink_climate_mode == HLINK_MODE_FAN) {
-               // Activity status is always 0x0000 in fan mode
-               this->hlink_entity_status_.action = esphome::climate::ClimateAction::CLIMATE_ACTION_FAN;
-             } else {
-               this->hlink_entity_status_.action = esphome::climate::ClimateAction::CLIMATE_ACTION_IDLE;
-             }
-           }
-         }});
   }
 }
 
@@ -898,29 +2001,19 @@ esphome::climate::ClimateTraits HlinkAc::traits() {
 #ifdef USE_SWITCH
 void HlinkAc::set_remote_lock_switch(switch_::Switch *sw) {
   this->remote_lock_switch_ = sw;
-  if (this->hlink_entity_status_.remote_control_lock.has_value()) {
-    this->remote_lock_switch_->publish_state(this->hlink_entity_status_.remote_control_lock.value());
+  if (this->hlink_entity_status_.remote_control_lock().has_value()) {
+    this->remote_lock_switch_->publish_state(this->hlink_entity_status_.remote_control_lock().value());
   }
-  this->status_.polling_features.push_back({{HlinkRequestFrame::Type::MT, {FeatureType::REMOTE_CONTROL_LOCK}},
-                                            [this, sw](const HlinkResponseFrame &response) {
-                                              auto remote_control_lock = response.p_value_as_uint16();
-                                              if (remote_control_lock.has_value()) {
-                                                this->hlink_entity_status_.remote_control_lock =
-                                                    static_cast<bool>(remote_control_lock.value());
-                                              } else {
-                                                this->hlink_entity_status_.remote_control_lock = {};
-                                              }
-                                            }});
 }
 
 void HlinkAc::set_remote_lock_state(bool state) {
   auto publish_current_state = [this]() {
-    this->remote_lock_switch_->publish_state(this->hlink_entity_status_.remote_control_lock.value());
+    this->remote_lock_switch_->publish_state(this->hlink_entity_status_.remote_control_lock().value());
   };
   this->enqueue_request_(
       HlinkRequestFrame::with_uint8(HlinkRequestFrame::Type::ST, FeatureType::REMOTE_CONTROL_LOCK, state),
       [this, state](const HlinkResponseFrame &response) {
-        this->hlink_entity_status_.remote_control_lock = state;
+        this->hlink_entity_status_.set_remote_control_lock(state);
         this->remote_lock_switch_->publish_state(state);
       },
       publish_current_state, publish_current_state, publish_current_state);
@@ -941,25 +2034,92 @@ void HlinkAc::handle_beep_state_change(bool state) {
 void HlinkAc::set_sensor(SensorType type, sensor::Sensor *s) {
   switch (type) {
     case SensorType::OUTDOOR_TEMPERATURE:
-      this->status_.polling_features.push_back({{HlinkRequestFrame::Type::MT, {FeatureType::CURRENT_OUTDOOR_TEMP}},
-                                                [this, s](const HlinkResponseFrame &response) {
-                                                  optional<int8_t> raw_sensor_value = response.p_value_as_int8();
-                                                  float sensor_value =
-                                                      (raw_sensor_value.has_value() && raw_sensor_value != 0x7E)
-                                                          ? raw_sensor_value.value()
-                                                          : NAN;
-                                                  this->update_sensor_state_(s, sensor_value);
-                                                }});
+      this->outdoor_temperature_sensor_ = s;
       break;
     case SensorType::INDOOR_TEMPERATURE:
       this->indoor_temperature_sensor_ = s;
-      if (this->hlink_entity_status_.current_temperature.has_value()) {
+      if (this->hlink_entity_status_.current_temperature().has_value()) {
         this->update_sensor_state_(this->indoor_temperature_sensor_,
-                                   this->hlink_entity_status_.current_temperature.value());
+                                   this->hlink_entity_status_.current_temperature().value());
       }
       break;
-    default:
+    case SensorType::REQUEST_RETRIES:
+      this->request_retries_sensor_ = s;
+      break;
+    case SensorType::DROPPED_REQUESTS:
+      this->dropped_requests_sensor_ = s;
+      break;
+    case SensorType::BUS_CONTENTION:
+      this->bus_contention_sensor_ = s;
+      break;
+    case SensorType::COMPRESSOR_ON_TIME_HOUR:
+      this->compressor_on_time_hour_sensor_ = s;
+      break;
+    case SensorType::COMPRESSOR_ON_TIME_DAY:
+      this->compressor_on_time_day_sensor_ = s;
+      break;
+    case SensorType::COMPRESSOR_CYCLES_HOUR:
+      this->compressor_cycles_hour_sensor_ = s;
+      break;
+    case SensorType::COMPRESSOR_MEAN_RUN_TIME:
+      this->compressor_mean_run_time_sensor_ = s;
+      break;
+    case SensorType::HEAT_TIME_DAY:
+      this->mode_time_day_sensors_[climate::CLIMATE_MODE_HEAT] = s;
+      break;
+    case SensorType::COOL_TIME_DAY:
+      this->mode_time_day_sensors_[climate::CLIMATE_MODE_COOL] = s;
+      break;
+    case SensorType::DRY_TIME_DAY:
+      this->mode_time_day_sensors_[climate::CLIMATE_MODE_DRY] = s;
+      break;
+    case SensorType::FAN_ONLY_TIME_DAY:
+      this->mode_time_day_sensors_[climate::CLIMATE_MODE_FAN_ONLY] = s;
+      break;
+    case SensorType::HEAT_COOL_TIME_DAY:
+      this->mode_time_day_sensors_[climate::CLIMATE_MODE_HEAT_COOL] = s;
+      break;
+    case SensorType::CONTROL_LATENCY_LAST:
+      this->control_latency_last_sensor_ = s;
+      break;
+    case SensorType::CONTROL_LATENCY_AVERAGE:
+      this->control_latency_average_sensor_ = s;
+      break;
+    case SensorType::CONTROL_LATENCY_MAX:
+      this->control_latency_max_sensor_ = s;
+      break;
+#ifdef HLINK_AC_ALLOCATION_ACCOUNTING
+    case SensorType::LOOP_HEAP_ALLOCATIONS:
+      this->loop_heap_allocations_sensor_ = s;
       break;
+#endif
+    default:
+      return;
+  }
+  if (this->duty_cycle_ == nullptr && type >= SensorType::COMPRESSOR_ON_TIME_HOUR &&
+      type <= SensorType::HEAT_COOL_TIME_DAY) {
+    this->duty_cycle_ = std::make_unique<HlinkDutyCycle>();
+  }
+}
+
+void HlinkAc::update_duty_cycle_() {
+  optional<climate::ClimateAction> action = this->hlink_entity_status_.action();
+  bool is_active = action.has_value() && (action.value() == climate::CLIMATE_ACTION_COOLING ||
+                                          action.value() == climate::CLIMATE_ACTION_HEATING ||
+                                          action.value() == climate::CLIMATE_ACTION_DRYING);
+  if (!this->duty_cycle_->update(millis(), is_active, this->hlink_entity_status_.mode())) {
+    return;
+  }
+  // Published once a minute, the values change slowly
+  const HlinkDutyCycle &duty_cycle = *this->duty_cycle_;
+  this->update_sensor_state_(this->compressor_on_time_hour_sensor_, duty_cycle.on_time_hour_s() / 60.0f);
+  this->update_sensor_state_(this->compressor_on_time_day_sensor_, duty_cycle.on_time_day_s() / 3600.0f);
+  this->update_sensor_state_(this->compressor_cycles_hour_sensor_, duty_cycle.cycles_hour());
+  uint32_t cycles_day = duty_cycle.cycles_day();
+  this->update_sensor_state_(this->compressor_mean_run_time_sensor_,
+                             cycles_day > 0 ? duty_cycle.on_time_day_s() / 60.0f / cycles_day : NAN);
+  for (uint8_t i = 0; i < DUTY_CYCLE_MODES; i++) {
+    this->update_sensor_state_(this->mode_time_day_sensors_[i], duty_cycle.mode_time_day_s(i) / 3600.0f);
   }
 }
 
@@ -969,6 +2129,7 @@ void HlinkAc::update_sensor_state_(sensor::Sensor *sensor, float value) {
     if (is_nanable_equal_(current_state, value)) {
       return;
     }
+    HLINK_ALLOCATION_EXCLUDED();
     sensor->publish_state(value);
   }
 }
@@ -977,14 +2138,10 @@ void HlinkAc::update_sensor_state_(sensor::Sensor *sensor, float value) {
 void HlinkAc::set_binary_sensor(BinarySensorType type, binary_sensor::BinarySensor *bs) {
   switch (type) {
     case BinarySensorType::AIR_FILTER_WARNING:
-      this->status_.polling_features.push_back({{HlinkRequestFrame::Type::MT, {FeatureType::AIR_FILTER_WARNING}},
-                                                [this, bs](const HlinkResponseFrame &response) {
-                                                  optional<int8_t> raw_sensor_value = response.p_value_as_int8();
-                                                  if (raw_sensor_value.has_value()) {
-                                                    bool sensor_value = raw_sensor_value.value() != 0;
-                                                    bs->publish_state(sensor_value);
-                                                  }
-                                                }});
+      this->air_filter_warning_binary_sensor_ = bs;
+      break;
+    case BinarySensorType::FAULT:
+      this->fault_binary_sensor_ = bs;
       break;
     default:
       break;
@@ -996,33 +2153,38 @@ void HlinkAc::set_text_sensor(TextSensorType type, text_sensor::TextSensor *text
   switch (type) {
     case TextSensorType::MODEL_NAME:
       this->model_name_text_sensor_ = text_sensor;
-      this->status_.polling_features.push_back(
-          {{HlinkRequestFrame::Type::MT, {FeatureType::MODEL_NAME}}, [this](const HlinkResponseFrame &response) {
-             if (response.p_value.has_value()) {
-               this->hlink_entity_status_.model_name = std::string(response.p_value->begin(), response.p_value->end());
-             }
-           }});
+      break;
+    case TextSensorType::ALARM:
+      this->alarm_text_sensor_ = text_sensor;
       break;
     default:
       break;
   }
 }
 
-void HlinkAc::set_debug_text_sensor(uint16_t address, text_sensor::TextSensor *text_sensor) {
-  this->status_.polling_features.push_back(
-      {{HlinkRequestFrame::Type::MT, {address}}, [text_sensor](const HlinkResponseFrame &response) {
-         if (response.p_value.has_value()) {
-           std::string response_value = response.p_value_as_string().value();
-           if (text_sensor->state != response_value) {
-             text_sensor->publish_state(response_value);
-           }
-         }
-       }});
+void HlinkAc::set_alarm_codes(const HlinkAlarmCode *alarm_codes, uint8_t count) {
+  this->alarm_codes_ = alarm_codes;
+  this->alarm_codes_count_ = count;
+}
+
+void HlinkAc::set_debug_text_sensor(uint8_t index, text_sensor::TextSensor *text_sensor) {
+  // Indexes match the entity indexes of the generated polling table
+  if (index >= this->debug_text_sensors_.size()) {
+    this->debug_text_sensors_.resize(index + 1, {nullptr, {}, false});
+  }
+  this->debug_text_sensors_[index].sensor = text_sensor;
 }
 
+#if defined(USE_TEXT_SENSOR) && defined(HLINK_AC_DEBUG_DISCOVERY)
 void HlinkAc::set_debug_discovery_text_sensor(text_sensor::TextSensor *ts) { this->debug_discovery_text_sensor_ = ts; }
 
-void HlinkAc::start_debug_discovery() {
+void HlinkAc::set_debug_discovery_batching(uint8_t batch_size, uint32_t batch_interval_ms) {
+  this->debug_discovery_batch_size_ = batch_size;
+  this->debug_discovery_batch_interval_ms_ = batch_interval_ms;
+}
+
+void HlinkAc::start_debug_discovery(optional<uint16_t> start_address, optional<uint16_t> end_address,
+                                    bool known_only) {
   if (this->debug_discovery_text_sensor_ == nullptr) {
     ESP_LOGW(TAG, "Debug discovery text sensor is not set.");
     return;
@@ -1031,37 +2193,130 @@ void HlinkAc::start_debug_discovery() {
     ESP_LOGI(TAG, "Debug discovery is already running.");
     return;
   }
-  auto create_discovery_request = std::make_shared<std::function<HlinkRequest(uint16_t)>>();
-  *create_discovery_request = [this, create_discovery_request](uint16_t address) {
-    return HlinkRequest{HlinkRequestFrame{HlinkRequestFrame::Type::MT, {address}},
-                        [this, address, create_discovery_request](const HlinkResponseFrame &response) mutable {
-                          char address_str[5];
-                          sprintf(address_str, "%04X", address);
-                          std::string sensor_value =
-                              std::string(address_str) + ":" + response.p_value_as_string().value();
-                          this->debug_discovery_text_sensor_->publish_state(sensor_value);
-                          if (this->debug_discovery_running_) {
-                            this->status_.low_priority_hlink_request = (*create_discovery_request)(address + 1);
-                          }
-                        },
-                        [this, address, create_discovery_request]() mutable {
-                          if (this->debug_discovery_running_) {
-                            this->status_.low_priority_hlink_request = (*create_discovery_request)(address + 1);
-                          }
-                        },
-                        [this, address, create_discovery_request]() mutable {
-                          if (this->debug_discovery_running_) {
-                            this->status_.low_priority_hlink_request = (*create_discovery_request)(address);
-                          }
-                        },
-                        [this, address, create_discovery_request]() mutable {
-                          if (this->debug_discovery_running_) {
-                            this->status_.low_priority_hlink_request = (*create_discovery_request)(address);
-                          }
-                        }};
-  };
-  this->status_.low_priority_hlink_request = (*create_discovery_request)(0x0000);
-  debug_discovery_running_ = true;
+  auto &discovery = this->debug_discovery_;
+  if (!start_address.has_value() && discovery.in_progress) {
+    ESP_LOGI(TAG, "Resuming debug discovery from %04X to %04X", discovery.next_address, discovery.end_address);
+  } else {
+    uint16_t start = start_address.value_or(0x0000);
+    uint16_t end = end_address.value_or(0xFFFF);
+    if (start > end) {
+      ESP_LOGW(TAG, "Invalid debug discovery range: %04X-%04X", start, end);
+      return;
+    }
+    if (known_only && !discovery.has_responsive_blocks()) {
+      ESP_LOGW(TAG, "No responsive addresses known yet, scanning the full range %04X-%04X", start, end);
+      known_only = false;
+    }
+    if (!known_only) {
+      // Blocks of the scanned range are marked again once their addresses respond
+      discovery.clear_blocks(start, end);
+    }
+    discovery.next_address = start;
+    discovery.end_address = end;
+    discovery.known_only = known_only;
+    discovery.in_progress = true;
+    ESP_LOGI(TAG, "Starting debug discovery from %04X to %04X%s", start, end, known_only ? " (known blocks only)" : "");
+  }
+  this->debug_discovery_running_ = true;
+  this->debug_discovery_attempts_ = 0;
+  this->schedule_debug_discovery_(discovery.next_address);
+}
+
+HlinkRequest HlinkAc::create_debug_discovery_request_(uint16_t address) {
+  return HlinkRequest{HlinkRequestFrame{HlinkRequestFrame::Type::MT, {address}},
+                      [this, address](const HlinkResponseFrame &response) {
+                        this->debug_discovery_.mark_block_responsive(address);
+                        this->append_debug_discovery_result_(address, response);
+                        if (this->debug_discovery_running_) {
+                          this->schedule_debug_discovery_(address + 1);
+                        }
+                      },
+                      [this, address]() {
+                        if (this->debug_discovery_running_) {
+                          this->schedule_debug_discovery_(address + 1);
+                        }
+                      },
+                      [this, address]() { this->retry_debug_discovery_(address); },
+                      [this, address]() { this->retry_debug_discovery_(address); }};
+}
+
+void HlinkAc::retry_debug_discovery_(uint16_t address) {
+  if (!this->debug_discovery_running_) {
+    return;
+  }
+  if (++this->debug_discovery_attempts_ < DEBUG_DISCOVERY_MAX_ATTEMPTS) {
+    this->schedule_debug_discovery_(address);
+    return;
+  }
+  ESP_LOGD(TAG, "Debug discovery skips %04X after %u failed attempts", address, this->debug_discovery_attempts_);
+  this->schedule_debug_discovery_(address + 1);
+}
+
+void HlinkAc::schedule_debug_discovery_(uint32_t address) {
+  auto &discovery = this->debug_discovery_;
+  if (discovery.known_only) {
+    // Jump over the blocks where nothing responded during previous scans
+    while (address <= discovery.end_address && !discovery.is_block_responsive(address)) {
+      address = (address / DEBUG_DISCOVERY_BLOCK_SIZE + 1) * DEBUG_DISCOVERY_BLOCK_SIZE;
+    }
+  }
+  bool entered_new_block = address / DEBUG_DISCOVERY_BLOCK_SIZE != discovery.next_address / DEBUG_DISCOVERY_BLOCK_SIZE;
+  if (address != discovery.next_address) {
+    this->debug_discovery_attempts_ = 0;
+  }
+  discovery.next_address = address;
+  if (address > discovery.end_address) {
+    ESP_LOGI(TAG, "Debug discovery finished at %04X", discovery.end_address);
+    discovery.in_progress = false;
+    this->debug_discovery_running_ = false;
+    this->save_debug_discovery_checkpoint_();
+    this->flush_debug_discovery_results_();
+    this->debug_discovery_text_sensor_->publish_state("Finished");
+    return;
+  }
+  if (entered_new_block) {
+    this->save_debug_discovery_checkpoint_();
+  }
+  this->status_.low_priority_hlink_request = this->create_debug_discovery_request_(address);
+}
+
+void HlinkAc::append_debug_discovery_result_(uint16_t address, const HlinkResponseFrame &response) {
+  size_t value_size = response.p_value.has_value() ? response.p_value->size() : 0;
+  // Separator + "XXXX:" + hex value
+  size_t entry_length = 1 + 5 + value_size * 2;
+  if (this->debug_discovery_batch_length_ + entry_length >= DEBUG_DISCOVERY_BATCH_BUFFER_SIZE) {
+    this->flush_debug_discovery_results_();
+  }
+  char *cursor = this->debug_discovery_batch_ + this->debug_discovery_batch_length_;
+  size_t space_left = DEBUG_DISCOVERY_BATCH_BUFFER_SIZE - this->debug_discovery_batch_length_;
+  int written = snprintf(cursor, space_left, "%s%04X:", this->debug_discovery_batch_count_ > 0 ? " " : "", address);
+  for (size_t i = 0; i < value_size && static_cast<size_t>(written) + 2 < space_left; i++) {
+    written += snprintf(cursor + written, space_left - written, "%02X", (*response.p_value)[i]);
+  }
+  if (this->debug_discovery_batch_count_ == 0) {
+    this->debug_discovery_batch_started_at_ms_ = millis();
+  }
+  this->debug_discovery_batch_length_ += written;
+  this->debug_discovery_batch_count_++;
+  if (this->debug_discovery_batch_count_ >= this->debug_discovery_batch_size_) {
+    this->flush_debug_discovery_results_();
+  }
+}
+
+void HlinkAc::flush_debug_discovery_results_() {
+  if (this->debug_discovery_batch_count_ == 0) {
+    return;
+  }
+  this->debug_discovery_text_sensor_->publish_state(
+      std::string(this->debug_discovery_batch_, this->debug_discovery_batch_length_));
+  this->debug_discovery_batch_length_ = 0;
+  this->debug_discovery_batch_count_ = 0;
+}
+
+void HlinkAc::save_debug_discovery_checkpoint_() {
+  if (!this->debug_discovery_rtc_.save(&this->debug_discovery_)) {
+    ESP_LOGW(TAG, "Failed to save debug discovery checkpoint");
+  }
 }
 
 void HlinkAc::stop_debug_discovery() {
@@ -1069,17 +2324,43 @@ void HlinkAc::stop_debug_discovery() {
     ESP_LOGW(TAG, "Debug discovery text sensor is not set.");
     return;
   }
-  debug_discovery_running_ = false;
+  this->debug_discovery_running_ = false;
+  this->status_.low_priority_hlink_request = {};
+  this->save_debug_discovery_checkpoint_();
+  this->flush_debug_discovery_results_();
   this->debug_discovery_text_sensor_->publish_state("Stopped");
 }
-
+#endif
 #endif
 void HlinkAc::enqueue_request_(HlinkRequestFrame request_frame,
                                std::function<void(const HlinkResponseFrame &response)> ok_callback,
                                std::function<void()> ng_callback, std::function<void()> invalid_callback,
-                               std::function<void()> timeout_callback) {
-  this->pending_action_requests_.enqueue(std::unique_ptr<HlinkRequest>(
-      new HlinkRequest{request_frame, ok_callback, ng_callback, invalid_callback, timeout_callback}));
+                               std::function<void()> timeout_callback, bool provisional) {
+  HlinkRequest request{request_frame, std::move(ok_callback), std::move(ng_callback), std::move(invalid_callback),
+                       std::move(timeout_callback), provisional};
+  request.enqueued_at_ms = millis();
+  HlinkRequest evicted;
+  RequestsQueueEnqueueResult result = this->pending_action_requests_.enqueue(std::move(request), evicted);
+  if (result == RequestsQueueEnqueueResult::ENQUEUED) {
+    return;
+  }
+  if (result == RequestsQueueEnqueueResult::COALESCED) {
+    // The newer write carries the change, the replaced one reports no result of its own and doesn't fail an
+    // optimistic state
+    ESP_LOGD(TAG, "Queued write to [%04X] is superseded by a newer one", evicted.request_frame.p.address);
+    if (evicted.provisional) {
+      this->finish_provisional_request_(true);
+    }
+    this->queue_overflows_++;
+    return;
+  }
+  // A rejected request is left untouched, otherwise the displaced one is finalized
+  HlinkRequest &dropped = result == RequestsQueueEnqueueResult::REJECTED ? request : evicted;
+  ESP_LOGW(TAG, "Action requests queue is full, request [%04X] is dropped", dropped.request_frame.p.address);
+  this->time_out_request_(dropped);
+  this->queue_overflows_++;
+  this->dropped_requests_++;
+  this->publish_request_counters_();
 }
 
 void HlinkAc::save_settings_() {
@@ -1109,38 +2390,5 @@ std::string HlinkAc::format_target_temperature_log_(optional<float> target_tempe
   return log;
 }
 
-int8_t CircularRequestsQueue::enqueue(std::unique_ptr<HlinkRequest> request) {
-  if (this->is_full()) {
-    ESP_LOGE(TAG, "Action requests queue is full");
-    return -1;
-  } else if (this->is_empty()) {
-    front_++;
-  }
-  rear_ = (rear_ + 1) % REQUESTS_QUEUE_SIZE;
-  requests_[rear_] = std::move(request);  // Transfer ownership using std::move
-  size_++;
-  return 1;
-}
-
-std::unique_ptr<HlinkRequest> CircularRequestsQueue::dequeue() {
-  if (this->is_empty())
-    return nullptr;
-  std::unique_ptr<HlinkRequest> dequeued_request = std::move(requests_[front_]);
-  if (front_ == rear_) {
-    front_ = -1;
-    rear_ = -1;
-  } else {
-    front_ = (front_ + 1) % REQUESTS_QUEUE_SIZE;
-  }
-  size_--;
-
-  return dequeued_request;
-}
-
-bool CircularRequestsQueue::is_empty() { return front_ == -1; }
-
-bool CircularRequestsQueue::is_full() { return (rear_ + 1) % REQUESTS_QUEUE_SIZE == front_; }
-
-uint8_t CircularRequestsQueue::size() { return size_; }
 }  // namespace hlink_ac
 }  // namespace esphome
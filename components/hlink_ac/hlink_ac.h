@@ -1,6 +1,7 @@
 #pragma once
 
 #include "esphome/core/component.h"
+#include "esphome/core/hal.h"
 #include "esphome/components/uart/uart.h"
 #include "esphome/components/climate/climate.h"
 
@@ -16,6 +17,9 @@
 #ifdef USE_TEXT_SENSOR
 #include "esphome/components/text_sensor/text_sensor.h"
 #endif
+#ifdef USE_NUMBER
+#include "esphome/components/number/number.h"
+#endif
 
 namespace esphome {
 namespace hlink_ac {
@@ -34,9 +38,29 @@ constexpr float AUTO_MODE_TARGET_TEMPERATURE_DELTA_MIN = -3.0f;
 constexpr float AUTO_MODE_TARGET_TEMPERATURE_DELTA_MAX = 3.0f;
 
 constexpr uint32_t MIN_INTERVAL_BETWEEN_REQUESTS = 60;
+// Frames are sent only after the bus has been silent for this long, so a conversation of another master isn't cut in
+constexpr uint32_t BUS_QUIET_WINDOW = MIN_INTERVAL_BETWEEN_REQUESTS;
 
 constexpr uint32_t DEFAULT_STATUS_UPDATE_INTERVAL = 5000;
 
+// Each frame times out after the p99 of the measured response times plus a margin. Until enough responses are
+// measured the conservative default is used, which is also the upper bound of the adaptive timeout.
+constexpr uint32_t DEFAULT_FRAME_TIMEOUT = 500;
+constexpr uint32_t MIN_FRAME_TIMEOUT = 60;
+constexpr uint32_t FRAME_TIMEOUT_MARGIN = 30;
+// Consecutive unanswered frames double the margin up to this many times, until any frame is answered
+constexpr uint8_t FRAME_TIMEOUT_MAX_BACKOFF_STEPS = 2;
+// Last resort guard against a stuck state, refreshed with every sent frame
+constexpr uint32_t FRAME_WATCHDOG_TIMEOUT = DEFAULT_FRAME_TIMEOUT * 2;
+constexpr uint8_t RESPONSE_TIME_BUCKET_MS = 10;
+constexpr uint8_t RESPONSE_TIME_BUCKETS = DEFAULT_FRAME_TIMEOUT / RESPONSE_TIME_BUCKET_MS;
+constexpr uint16_t RESPONSE_TIME_MIN_SAMPLES = 20;
+constexpr uint16_t RESPONSE_TIME_MAX_SAMPLES = 512;
+
+// Control requests are resent with exponential backoff when they are not acknowledged in time
+constexpr uint32_t REQUEST_RETRY_BACKOFF = 100;
+constexpr uint8_t MAX_REQUEST_RETRIES = 3;
+
 enum HlinkComponentState : uint8_t {
   IDLE,
   REQUEST_NEXT_STATUS_FEATURE,
@@ -47,24 +71,206 @@ enum HlinkComponentState : uint8_t {
   ACK_APPLIED_REQUEST
 };
 
-struct HlinkEntityStatus {
-  optional<bool> power_state;
-  optional<uint16_t> hlink_climate_mode;
-  optional<esphome::climate::ClimateMode> mode;
-  optional<esphome::climate::ClimateAction> action;
-  optional<float> current_temperature;
-  optional<float> target_temperature;
-  optional<esphome::climate::ClimateFanMode> fan_mode;
-  optional<esphome::climate::ClimateSwingMode> swing_mode;
-  optional<bool> leave_home_enabled;
-  optional<std::string> model_name;
+// Field bits of HlinkEntityStatus, used for its validity, pending publish and changed masks
+enum HlinkStatusField : uint16_t {
+  HLINK_STATUS_POWER_STATE = 1 << 0,
+  HLINK_STATUS_MODE = 1 << 1,
+  HLINK_STATUS_ACTION = 1 << 2,
+  HLINK_STATUS_CURRENT_TEMPERATURE = 1 << 3,
+  HLINK_STATUS_TARGET_TEMPERATURE = 1 << 4,
+  HLINK_STATUS_FAN_MODE = 1 << 5,
+  HLINK_STATUS_SWING_MODE = 1 << 6,
+  HLINK_STATUS_LEAVE_HOME = 1 << 7,
+  HLINK_STATUS_ALARM_CODE = 1 << 8,
+  HLINK_STATUS_OUTDOOR_TEMPERATURE = 1 << 9,
+  HLINK_STATUS_REMOTE_CONTROL_LOCK = 1 << 10,
+  HLINK_STATUS_HLINK_CLIMATE_MODE = 1 << 11,
+};
+
+// Fields published through the climate entity
+constexpr uint16_t HLINK_STATUS_CLIMATE_FIELDS =
+    HLINK_STATUS_POWER_STATE | HLINK_STATUS_MODE | HLINK_STATUS_ACTION | HLINK_STATUS_CURRENT_TEMPERATURE |
+    HLINK_STATUS_TARGET_TEMPERATURE | HLINK_STATUS_FAN_MODE | HLINK_STATUS_SWING_MODE | HLINK_STATUS_LEAVE_HOME |
+    HLINK_STATUS_HLINK_CLIMATE_MODE;
+constexpr uint16_t HLINK_STATUS_MINIMAL_HVAC_FIELDS = HLINK_STATUS_POWER_STATE | HLINK_STATUS_MODE |
+                                                      HLINK_STATUS_CURRENT_TEMPERATURE |
+                                                      HLINK_STATUS_TARGET_TEMPERATURE;
+// Indoor and target temperatures are kept in half degrees, the unknown (NAN) target temperature as INT8_MIN
+constexpr int8_t HLINK_STATUS_NO_TEMPERATURE = INT8_MIN;
+
+// Status of the unit packed into a few bytes: enums in bit fields, temperatures as int8 and a validity bit per field.
+// Setters raise the pending bits of a field only when its value actually changes, so publishing and change
+// notifications are decided by testing a mask instead of comparing every field.
+class HlinkEntityStatus {
+ public:
+  HlinkEntityStatus()
+      : mode_(0),
+        action_(0),
+        power_state_(0),
+        leave_home_enabled_(0),
+        fan_mode_(0),
+        swing_mode_(0),
+        remote_control_lock_(0) {}
+
+  optional<bool> power_state() const { return this->get_<bool>(HLINK_STATUS_POWER_STATE, this->power_state_); }
+  optional<uint16_t> hlink_climate_mode() const {
+    return this->get_<uint16_t>(HLINK_STATUS_HLINK_CLIMATE_MODE, this->hlink_climate_mode_);
+  }
+  optional<esphome::climate::ClimateMode> mode() const {
+    return this->get_<esphome::climate::ClimateMode>(HLINK_STATUS_MODE, this->mode_);
+  }
+  optional<esphome::climate::ClimateAction> action() const {
+    return this->get_<esphome::climate::ClimateAction>(HLINK_STATUS_ACTION, this->action_);
+  }
+  optional<float> current_temperature() const {
+    return this->get_<float>(HLINK_STATUS_CURRENT_TEMPERATURE, decode_temperature_(this->current_temperature_));
+  }
+  optional<float> target_temperature() const {
+    return this->get_<float>(HLINK_STATUS_TARGET_TEMPERATURE, decode_temperature_(this->target_temperature_));
+  }
+  optional<esphome::climate::ClimateFanMode> fan_mode() const {
+    return this->get_<esphome::climate::ClimateFanMode>(HLINK_STATUS_FAN_MODE, this->fan_mode_);
+  }
+  optional<esphome::climate::ClimateSwingMode> swing_mode() const {
+    return this->get_<esphome::climate::ClimateSwingMode>(HLINK_STATUS_SWING_MODE, this->swing_mode_);
+  }
+  optional<bool> leave_home_enabled() const {
+    return this->get_<bool>(HLINK_STATUS_LEAVE_HOME, this->leave_home_enabled_);
+  }
+  optional<uint16_t> alarm_code() const { return this->get_<uint16_t>(HLINK_STATUS_ALARM_CODE, this->alarm_code_); }
+  optional<int8_t> outdoor_temperature() const {
+    return this->get_<int8_t>(HLINK_STATUS_OUTDOOR_TEMPERATURE, this->outdoor_temperature_);
+  }
 #ifdef USE_SWITCH
-  optional<bool> remote_control_lock;
+  optional<bool> remote_control_lock() const {
+    return this->get_<bool>(HLINK_STATUS_REMOTE_CONTROL_LOCK, this->remote_control_lock_);
+  }
 #endif
-  bool has_minimal_hvac_status() {
-    return power_state.has_value() && current_temperature.has_value() && target_temperature.has_value() &&
-           mode.has_value();
+
+  void set_power_state(optional<bool> value) {
+    if (this->update_(HLINK_STATUS_POWER_STATE, value.has_value(), value == this->power_state_))
+      this->power_state_ = *value;
+  }
+  void set_hlink_climate_mode(optional<uint16_t> value) {
+    if (this->update_(HLINK_STATUS_HLINK_CLIMATE_MODE, value.has_value(), value == this->hlink_climate_mode_))
+      this->hlink_climate_mode_ = *value;
+  }
+  void set_mode(optional<esphome::climate::ClimateMode> value) {
+    if (this->update_(HLINK_STATUS_MODE, value.has_value(), value == this->mode_))
+      this->mode_ = *value;
+  }
+  void set_action(optional<esphome::climate::ClimateAction> value) {
+    if (this->update_(HLINK_STATUS_ACTION, value.has_value(), value == this->action_))
+      this->action_ = *value;
+  }
+  void set_current_temperature(optional<float> value) {
+    int8_t encoded = encode_temperature_(value.value_or(NAN));
+    if (this->update_(HLINK_STATUS_CURRENT_TEMPERATURE, value.has_value(), encoded == this->current_temperature_))
+      this->current_temperature_ = encoded;
+  }
+  void set_target_temperature(optional<float> value) {
+    int8_t encoded = encode_temperature_(value.value_or(NAN));
+    if (this->update_(HLINK_STATUS_TARGET_TEMPERATURE, value.has_value(), encoded == this->target_temperature_))
+      this->target_temperature_ = encoded;
+  }
+  void set_fan_mode(optional<esphome::climate::ClimateFanMode> value) {
+    if (this->update_(HLINK_STATUS_FAN_MODE, value.has_value(), value == this->fan_mode_))
+      this->fan_mode_ = *value;
   }
+  void set_swing_mode(optional<esphome::climate::ClimateSwingMode> value) {
+    if (this->update_(HLINK_STATUS_SWING_MODE, value.has_value(), value == this->swing_mode_))
+      this->swing_mode_ = *value;
+  }
+  void set_leave_home_enabled(optional<bool> value) {
+    if (this->update_(HLINK_STATUS_LEAVE_HOME, value.has_value(), value == this->leave_home_enabled_))
+      this->leave_home_enabled_ = *value;
+  }
+  void set_alarm_code(optional<uint16_t> value) {
+    if (this->update_(HLINK_STATUS_ALARM_CODE, value.has_value(), value == this->alarm_code_))
+      this->alarm_code_ = *value;
+  }
+  void set_outdoor_temperature(optional<int8_t> value) {
+    if (this->update_(HLINK_STATUS_OUTDOOR_TEMPERATURE, value.has_value(), value == this->outdoor_temperature_))
+      this->outdoor_temperature_ = *value;
+  }
+#ifdef USE_SWITCH
+  void set_remote_control_lock(optional<bool> value) {
+    if (this->update_(HLINK_STATUS_REMOTE_CONTROL_LOCK, value.has_value(), value == this->remote_control_lock_))
+      this->remote_control_lock_ = *value;
+  }
+#endif
+
+  bool has_minimal_hvac_status() const {
+    return (this->valid_fields_ & HLINK_STATUS_MINIMAL_HVAC_FIELDS) == HLINK_STATUS_MINIMAL_HVAC_FIELDS;
+  }
+  bool is_pending_publish(uint16_t fields) const { return (this->pending_publish_ & fields) != 0; }
+  // Forces the fields to be published again, e.g. to roll back a provisional state
+  void mark_pending_publish(uint16_t fields) { this->pending_publish_ |= fields; }
+  // Returns and clears the pending bits of the fields
+  uint16_t take_pending_publish(uint16_t fields) {
+    uint16_t pending = this->pending_publish_ & fields;
+    this->pending_publish_ &= ~fields;
+    return pending;
+  }
+  // Starts a new version when fields changed since the previous call and returns their bits
+  uint16_t commit_changes() {
+    uint16_t changed_fields = this->pending_notify_;
+    if (changed_fields != 0) {
+      this->pending_notify_ = 0;
+      this->changed_fields_ = changed_fields;
+      this->version_++;
+    }
+    return changed_fields;
+  }
+  // Incremented on every notified change, changed_fields() holds the field bits of the latest one
+  uint32_t version() const { return this->version_; }
+  uint16_t changed_fields() const { return this->changed_fields_; }
+
+ protected:
+  template<typename T, typename S> optional<T> get_(uint16_t field, S value) const {
+    if ((this->valid_fields_ & field) == 0) {
+      return {};
+    }
+    return static_cast<T>(value);
+  }
+  // Returns true when the new value has to be stored
+  bool update_(uint16_t field, bool has_value, bool is_same_value) {
+    bool is_valid = (this->valid_fields_ & field) != 0;
+    if (is_valid == has_value && (!has_value || is_same_value)) {
+      return false;
+    }
+    this->valid_fields_ = has_value ? this->valid_fields_ | field : this->valid_fields_ & ~field;
+    this->pending_publish_ |= field;
+    this->pending_notify_ |= field;
+    return has_value;
+  }
+  static int8_t encode_temperature_(float temperature) {
+    if (std::isnan(temperature) || temperature < -63.5f || temperature > 63.5f) {
+      return HLINK_STATUS_NO_TEMPERATURE;
+    }
+    return static_cast<int8_t>(lroundf(temperature * 2));
+  }
+  static float decode_temperature_(int8_t temperature) {
+    return temperature == HLINK_STATUS_NO_TEMPERATURE ? NAN : temperature / 2.0f;
+  }
+
+  uint32_t version_{0};
+  uint16_t valid_fields_{0};
+  uint16_t pending_publish_{0};
+  uint16_t pending_notify_{0};
+  uint16_t changed_fields_{0};
+  uint16_t hlink_climate_mode_{0};
+  uint16_t alarm_code_{0};
+  int8_t current_temperature_{HLINK_STATUS_NO_TEMPERATURE};
+  int8_t target_temperature_{HLINK_STATUS_NO_TEMPERATURE};
+  int8_t outdoor_temperature_{0};
+  uint8_t mode_ : 3;
+  uint8_t action_ : 3;
+  uint8_t power_state_ : 1;
+  uint8_t leave_home_enabled_ : 1;
+  uint8_t fan_mode_ : 4;
+  uint8_t swing_mode_ : 2;
+  uint8_t remote_control_lock_ : 1;
 };
 
 enum FeatureType : uint16_t {
@@ -79,6 +285,7 @@ enum FeatureType : uint16_t {
   CURRENT_OUTDOOR_TEMP = 0x0102,  // Available only when unit is working, otherwise might return 7E value
   LEAVE_HOME_STATUS_WRITE = 0x0300,
   ACTIVITY_STATUS = 0x0301,  // 0000=Stand-by FFFF=Active
+  ALARM_CODE = 0x0201,  // 0000 when there is no failure
   AIR_FILTER_WARNING = 0x302,
   LEAVE_HOME_STATUS_READ = 0x0304,
   BEEPER = 0x0800,  // Triggers beeper sound
@@ -112,43 +319,109 @@ constexpr uint8_t HLINK_BEEP_ACTION = 0x07;
 
 constexpr uint16_t HLINK_ACTIVE_ON = 0xFFFF;
 
+constexpr uint16_t HLINK_NO_ALARM = 0x0000;
+
 const uint8_t HLINK_LEAVE_HOME_ENABLED = 0x80;
 const uint8_t HLINK_LEAVE_HOME_DISABLED = 0x00;
 
 const uint16_t HLINK_ENABLE_LEAVE_HOME = 0x0040;
 const uint16_t HLINK_DISABLE_LEAVE_HOME = 0x0000;
 
+// Frame payloads are stored in place, so frames are copied around without touching the heap
+template<uint8_t Capacity> struct HlinkPayload {
+  uint8_t bytes[Capacity];
+  uint8_t length = 0;
+
+  HlinkPayload() = default;
+  HlinkPayload(std::initializer_list<uint8_t> values) {
+    for (uint8_t value : values) {
+      push_back(value);
+    }
+  }
+
+  static constexpr uint8_t capacity() { return Capacity; }
+  size_t size() const { return length; }
+  bool empty() const { return length == 0; }
+  const uint8_t *begin() const { return bytes; }
+  const uint8_t *end() const { return bytes + length; }
+  uint8_t operator[](size_t index) const { return bytes[index]; }
+  uint8_t back() const { return bytes[length - 1]; }
+  bool push_back(uint8_t value) {
+    if (length >= Capacity) {
+      return false;
+    }
+    bytes[length++] = value;
+    return true;
+  }
+  bool operator==(const HlinkPayload &other) const {
+    return length == other.length && std::equal(begin(), end(), other.begin());
+  }
+};
+
+// Parses "0A" into 0x0A, returns false on non-hex characters
+inline bool parse_hex_byte(const char *hex, uint8_t &value) {
+  value = 0;
+  for (uint8_t i = 0; i < 2; i++) {
+    char c = hex[i];
+    uint8_t nibble;
+    if (c >= '0' && c <= '9') {
+      nibble = c - '0';
+    } else if (c >= 'A' && c <= 'F') {
+      nibble = c - 'A' + 10;
+    } else if (c >= 'a' && c <= 'f') {
+      nibble = c - 'a' + 10;
+    } else {
+      return false;
+    }
+    value = (value << 4) | nibble;
+  }
+  return true;
+}
+
+// Writes are short, the longest known payload is the 2 byte value of a register
+constexpr uint8_t HLINK_MAX_REQUEST_PAYLOAD_SIZE = 8;
+// Whatever fits into "OK P=... C=XXXX\r" in the read buffer
+constexpr uint8_t HLINK_MAX_RESPONSE_PAYLOAD_SIZE = (HLINK_MSG_READ_BUFFER_SIZE - 13) / 2;
+using HlinkRequestPayload = HlinkPayload<HLINK_MAX_REQUEST_PAYLOAD_SIZE>;
+using HlinkResponsePayload = HlinkPayload<HLINK_MAX_RESPONSE_PAYLOAD_SIZE>;
+// "ST P=XXXX,DATA C=XXXX\r" and the terminating null
+constexpr uint8_t HLINK_MSG_WRITE_BUFFER_SIZE = 18 + HLINK_MAX_REQUEST_PAYLOAD_SIZE * 2 + 1;
+
 struct HlinkRequestFrame {
   enum class Type { MT, ST };
   struct ProgramPayload {
     uint16_t address;
-    optional<std::vector<uint8_t>> data;
+    optional<HlinkRequestPayload> data;
   };
   Type type;
   ProgramPayload p;
 
   static HlinkRequestFrame with_uint8(HlinkRequestFrame::Type type, uint16_t address, uint8_t data) {
-    return {type, {address, std::vector<uint8_t>{data}}};
+    return {type, {address, HlinkRequestPayload{data}}};
   }
 
   static HlinkRequestFrame with_uint16(HlinkRequestFrame::Type type, uint16_t address, uint16_t data) {
-    return {
-        type,
-        {address, std::vector<uint8_t>{static_cast<uint8_t>((data >> 8) & 0xFF), static_cast<uint8_t>(data & 0xFF)}}};
+    return {type, {address, HlinkRequestPayload{static_cast<uint8_t>((data >> 8) & 0xFF),
+                                                 static_cast<uint8_t>(data & 0xFF)}}};
   }
 
+  // Expects a hex string validated by the caller, at most HLINK_MAX_REQUEST_PAYLOAD_SIZE bytes long
   static HlinkRequestFrame with_string(HlinkRequestFrame::Type type, uint16_t address, const std::string &data) {
-    std::vector<uint8_t> vector_data;
-    for (size_t i = 0; i < data.length(); i += 2) {
-      vector_data.push_back(static_cast<uint8_t>(std::stoi(data.substr(i, 2), nullptr, 16)));
+    HlinkRequestPayload payload;
+    for (size_t i = 0; i + 1 < data.length(); i += 2) {
+      uint8_t value;
+      if (parse_hex_byte(&data[i], value)) {
+        payload.push_back(value);
+      }
     }
-    return {type, {address, vector_data}};
+    return {type, {address, payload}};
   }
 };
 struct HlinkResponseFrame {
-  enum class Status { NOTHING, PARTIAL, OK, NG, INVALID };
+  // COLLISION: a request of another master arrived instead of the response, the next response answers that request
+  enum class Status { NOTHING, PARTIAL, OK, NG, INVALID, COLLISION };
   Status status;
-  optional<std::vector<uint8_t>> p_value;
+  optional<HlinkResponsePayload> p_value;
   uint16_t checksum;
 
   optional<uint16_t> p_value_as_uint16() const {
@@ -188,22 +461,482 @@ struct HlinkRequest {
   std::function<void()> ng_callback;
   std::function<void()> invalid_callback;
   std::function<void()> timeout_callback;
+  // Optimistic control request, its result confirms or rolls back the published climate state
+  bool provisional = false;
+  uint8_t attempts = 0;
+  uint32_t enqueued_at_ms = 0;
+  // First attempt, retries are accounted as time on the bus
+  uint32_t sent_at_ms = 0;
+};
+
+// Upper edges of the control latency histogram buckets, the last bucket collects everything slower
+constexpr uint16_t CONTROL_LATENCY_BUCKET_EDGES_MS[] = {50, 100, 250, 500, 1000, 2000, 5000};
+constexpr uint8_t CONTROL_LATENCY_BUCKETS = sizeof(CONTROL_LATENCY_BUCKET_EDGES_MS) / sizeof(uint16_t) + 1;
+
+struct HlinkLatencyStats {
+  uint32_t last_ms = 0;
+  uint32_t max_ms = 0;
+  uint32_t samples = 0;
+  uint64_t total_ms = 0;
+  uint16_t buckets[CONTROL_LATENCY_BUCKETS] = {};
+
+  void add_sample(uint32_t latency_ms) {
+    last_ms = latency_ms;
+    max_ms = std::max(max_ms, latency_ms);
+    samples++;
+    total_ms += latency_ms;
+    uint8_t bucket = 0;
+    while (bucket < CONTROL_LATENCY_BUCKETS - 1 && latency_ms > CONTROL_LATENCY_BUCKET_EDGES_MS[bucket]) {
+      bucket++;
+    }
+    if (buckets[bucket] < UINT16_MAX) {
+      buckets[bucket]++;
+    }
+  }
+  uint32_t average_ms() const { return samples == 0 ? 0 : static_cast<uint32_t>(total_ms / samples); }
+};
+
+// Acknowledged control requests split into stages, from control() or a raw command to the published state
+struct HlinkControlLatency {
+  // Waiting in the queue until the first attempt is sent
+  HlinkLatencyStats queued;
+  // From the first attempt to the ACK, retries included
+  HlinkLatencyStats bus;
+  // Handling of the ACK: entity status update and state publishing
+  HlinkLatencyStats publish;
+  HlinkLatencyStats end_to_end;
+};
+
+// Consecutive NG responses after which a polled address is treated as unsupported by the unit
+constexpr uint8_t UNSUPPORTED_FEATURE_NG_THRESHOLD = 3;
+constexpr uint32_t UNSUPPORTED_FEATURE_RECHECK_INTERVAL = 60 * 60 * 1000;
+constexpr uint8_t MAX_PERSISTED_UNSUPPORTED_FEATURES = 8;
+// Features with an uninformative value in the current state are polled only every Nth cycle
+constexpr uint8_t UNINFORMATIVE_FEATURE_POLL_DIVIDER = 10;
+
+// Decodes a polled response into the entity status or a platform entity
+enum class HlinkDecoder : uint8_t {
+  POWER_STATE,
+  MODE,
+  TARGET_TEMP,
+  CURRENT_INDOOR_TEMP,
+  FAN_MODE,
+  SWING_MODE,
+  LEAVE_HOME_STATUS,
+  ACTIVITY_STATUS,
+  CURRENT_OUTDOOR_TEMP,
+  AIR_FILTER_WARNING,
+  REMOTE_CONTROL_LOCK,
+  MODEL_NAME,
+  DEBUG_TEXT_SENSOR,
+  CUSTOM_REGISTER,
+  ALARM_CODE,
+};
+
+// Polling tables are generated by codegen from the YAML configuration and kept in flash (PROGMEM)
+struct HlinkPollingDescriptor {
+  uint16_t address;
+  // Precomputed "MT P=XXXX C=YYYY\r" read frame
+  char frame[18];
+  uint8_t first_subscriber;
+  uint8_t subscriber_count;
+  // 0 means the address is read on every polling cycle
+  uint32_t poll_interval_ms;
+};
+
+struct HlinkPollingSubscriber {
+  HlinkDecoder decoder;
+  // Index of the target entity for decoders with several instances, e.g. debug text sensors
+  uint8_t entity_index;
+};
+
+// Runtime state of a polled address, each address crosses the bus once per cycle for all its subscribers
+struct HlinkPollingFeature {
+  bool unsupported = false;
+  uint8_t consecutive_ng_count = 0;
+  uint32_t next_support_check_at_ms = 0;
+  // Completed polling cycle during which the read frame was last sent
+  uint16_t polled_at_cycle = 0;
+  uint32_t last_polled_at_ms = 0;
+  // Passive mode: last time another master on the bus read this address
+  uint32_t last_sniffed_at_ms = 0;
+
+  // Decides whether the feature is requested in the current cycle, cycles aborted before completion don't count
+  bool should_poll(uint32_t now, uint16_t completed_cycles, bool is_informative, uint32_t poll_interval_ms) const {
+    if (unsupported) {
+      return static_cast<int32_t>(now - next_support_check_at_ms) >= 0;
+    }
+    if (poll_interval_ms > 0 && last_polled_at_ms != 0 && now - last_polled_at_ms < poll_interval_ms) {
+      return false;
+    }
+    return is_informative ||
+           static_cast<uint16_t>(completed_cycles - polled_at_cycle) >= UNINFORMATIVE_FEATURE_POLL_DIVIDER;
+  }
+
+  // Called once the read frame is on the bus
+  void mark_polled(uint32_t now, uint16_t completed_cycles) {
+    last_polled_at_ms = now;
+    polled_at_cycle = completed_cycles;
+  }
+};
+
+struct HlinkCapabilities {
+  uint8_t unsupported_count;
+  uint16_t unsupported_addresses[MAX_PERSISTED_UNSUPPORTED_FEATURES];
+};
+
+// Histogram of frame round-trip times, from sending a request to receiving the complete response
+struct HlinkResponseTimes {
+  uint16_t buckets[RESPONSE_TIME_BUCKETS] = {};
+  uint16_t samples = 0;
+  uint32_t frame_timeout_ms = DEFAULT_FRAME_TIMEOUT;
+  // Timeout derived from the histogram alone, before the back-off of consecutive timeouts
+  uint32_t measured_timeout_ms = DEFAULT_FRAME_TIMEOUT;
+  uint32_t timeouts = 0;
+  uint8_t consecutive_timeouts = 0;
+
+  void add_sample(uint32_t round_trip_ms) {
+    uint32_t bucket = round_trip_ms / RESPONSE_TIME_BUCKET_MS;
+    buckets[bucket < RESPONSE_TIME_BUCKETS ? bucket : RESPONSE_TIME_BUCKETS - 1]++;
+    if (++samples >= RESPONSE_TIME_MAX_SAMPLES) {
+      // Age the histogram so it follows changes of the bus timing
+      samples = 0;
+      for (auto &count : buckets) {
+        count /= 2;
+        samples += count;
+      }
+    }
+    consecutive_timeouts = 0;
+    if (samples < RESPONSE_TIME_MIN_SAMPLES) {
+      measured_timeout_ms = DEFAULT_FRAME_TIMEOUT;
+    } else {
+      uint32_t timeout_ms = percentile_ms(99) + FRAME_TIMEOUT_MARGIN;
+      measured_timeout_ms = timeout_ms < MIN_FRAME_TIMEOUT       ? MIN_FRAME_TIMEOUT
+                            : timeout_ms > DEFAULT_FRAME_TIMEOUT ? DEFAULT_FRAME_TIMEOUT
+                                                                 : timeout_ms;
+    }
+    frame_timeout_ms = measured_timeout_ms;
+  }
+
+  // An unanswered frame isn't a latency sample, otherwise a register that never answers would ratchet the p99 up to
+  // the cap. The timeout backs off instead, and falls back to the measured one with the next answered frame.
+  void add_timeout() {
+    timeouts++;
+    if (consecutive_timeouts < FRAME_TIMEOUT_MAX_BACKOFF_STEPS) {
+      consecutive_timeouts++;
+    }
+    uint32_t timeout_ms = measured_timeout_ms + (FRAME_TIMEOUT_MARGIN << consecutive_timeouts);
+    frame_timeout_ms = timeout_ms > DEFAULT_FRAME_TIMEOUT ? DEFAULT_FRAME_TIMEOUT : timeout_ms;
+  }
+
+  // Upper edge of the bucket containing the given percentile
+  uint32_t percentile_ms(uint8_t percent) const {
+    uint32_t threshold = (static_cast<uint32_t>(samples) * percent + 99) / 100;
+    uint32_t cumulative = 0;
+    for (uint8_t i = 0; i < RESPONSE_TIME_BUCKETS; i++) {
+      cumulative += buckets[i];
+      if (cumulative >= threshold) {
+        return (i + 1) * RESPONSE_TIME_BUCKET_MS;
+      }
+    }
+    return DEFAULT_FRAME_TIMEOUT;
+  }
+};
+
+#ifdef HLINK_AC_RAW_COMMANDS
+// Latest responses of MT reads, shared by polling and raw commands
+constexpr uint8_t HLINK_READ_CACHE_SIZE = 16;
+constexpr uint8_t HLINK_READ_CACHE_VALUE_SIZE = 16;
+
+struct HlinkReadCacheEntry {
+  uint16_t address;
+  // 0 marks an empty entry
+  uint8_t size;
+  uint8_t value[HLINK_READ_CACHE_VALUE_SIZE];
+  uint32_t read_at_ms;
+};
+
+struct HlinkReadCache {
+  // Entries are allocated only when the cache is enabled with a non-zero TTL
+  std::vector<HlinkReadCacheEntry> entries;
+  uint32_t ttl_ms = 0;
+  uint32_t hits = 0;
+
+  void set_ttl(uint32_t ttl) {
+    ttl_ms = ttl;
+    entries.assign(ttl > 0 ? HLINK_READ_CACHE_SIZE : 0, HlinkReadCacheEntry{});
+  }
+
+  void store(uint16_t address, const HlinkResponsePayload &value, uint32_t now) {
+    if (entries.empty() || value.empty() || value.size() > HLINK_READ_CACHE_VALUE_SIZE) {
+      return;
+    }
+    // Refresh the entry of the address, or replace an empty or the oldest one
+    HlinkReadCacheEntry *target = &entries[0];
+    for (auto &entry : entries) {
+      if (entry.size > 0 && entry.address == address) {
+        target = &entry;
+        break;
+      }
+      if (target->size > 0 && (entry.size == 0 || now - entry.read_at_ms > now - target->read_at_ms)) {
+        target = &entry;
+      }
+    }
+    target->address = address;
+    target->size = value.size();
+    std::copy(value.begin(), value.end(), target->value);
+    target->read_at_ms = now;
+  }
+
+  void invalidate(uint16_t address) {
+    for (auto &entry : entries) {
+      if (entry.size > 0 && entry.address == address) {
+        entry.size = 0;
+      }
+    }
+  }
+
+  // Hex string of a value younger than the TTL, in the same format as HlinkResponseFrame::p_value_as_string()
+  optional<std::string> get_fresh_value(uint16_t address, uint32_t now) {
+    for (const auto &entry : entries) {
+      if (entry.size > 0 && entry.address == address && now - entry.read_at_ms <= ttl_ms) {
+        hits++;
+        std::string hex_string;
+        for (uint8_t i = 0; i < entry.size; i++) {
+          char buffer[3];
+          sprintf(buffer, "%02X", entry.value[i]);
+          hex_string += buffer;
+        }
+        return hex_string;
+      }
+    }
+    return {};
+  }
+};
+#endif
+
+constexpr uint32_t DUTY_CYCLE_MINUTE = 60 * 1000;
+constexpr uint8_t DUTY_CYCLE_MINUTES = 60;
+constexpr uint8_t DUTY_CYCLE_HOURS = 24;
+// Indexed by climate::ClimateMode
+constexpr uint8_t DUTY_CYCLE_MODES = climate::CLIMATE_MODE_AUTO + 1;
+// Longer gaps between the updates, e.g. a lost communication, aren't accounted
+constexpr uint32_t DUTY_CYCLE_MAX_UPDATE_GAP = DUTY_CYCLE_MINUTE;
+
+struct HlinkDutyCycleMinute {
+  uint16_t on_ms;
+  uint8_t cycles;
+};
+
+struct HlinkDutyCycleHour {
+  uint16_t on_s;
+  uint16_t cycles;
+  uint16_t mode_s[DUTY_CYCLE_MODES];
+};
+
+// Rolling compressor statistics of the last hour (by minute) and the last day (by hour), updated incrementally from
+// the polled activity status instead of storing every transition
+struct HlinkDutyCycle {
+  HlinkDutyCycleMinute minutes[DUTY_CYCLE_MINUTES] = {};
+  HlinkDutyCycleHour hours[DUTY_CYCLE_HOURS] = {};
+  uint8_t minute = 0;
+  uint8_t hour = 0;
+  uint8_t closed_minutes_in_hour = 0;
+  uint32_t minute_mode_ms[DUTY_CYCLE_MODES] = {};
+  uint32_t minute_started_at_ms = 0;
+  uint32_t last_update_at_ms = 0;
+  bool started = false;
+  bool active = false;
+  optional<climate::ClimateMode> mode;
+
+  // Returns true once a minute is closed, i.e. when the statistics are worth publishing
+  bool update(uint32_t now, bool is_active, optional<climate::ClimateMode> current_mode) {
+    if (!started) {
+      started = true;
+      minute_started_at_ms = last_update_at_ms = now;
+      active = is_active;
+      mode = current_mode;
+      return false;
+    }
+    // The previous state lasted until this update
+    uint32_t elapsed_ms = now - last_update_at_ms;
+    last_update_at_ms = now;
+    if (elapsed_ms <= DUTY_CYCLE_MAX_UPDATE_GAP) {
+      if (active) {
+        minutes[minute].on_ms = std::min<uint32_t>(minutes[minute].on_ms + elapsed_ms, DUTY_CYCLE_MINUTE);
+      }
+      if (mode.has_value() && mode.value() < DUTY_CYCLE_MODES) {
+        minute_mode_ms[mode.value()] += elapsed_ms;
+      }
+    }
+    if (is_active && !active) {
+      minutes[minute].cycles++;
+      hours[hour].cycles++;
+    }
+    active = is_active;
+    mode = current_mode;
+    if (now - minute_started_at_ms < DUTY_CYCLE_MINUTE) {
+      return false;
+    }
+    close_minute_();
+    // Don't catch up with the minutes missed during a long gap
+    minute_started_at_ms = now - minute_started_at_ms < 2 * DUTY_CYCLE_MINUTE ? minute_started_at_ms + DUTY_CYCLE_MINUTE
+                                                                              : now;
+    return true;
+  }
+
+  uint32_t on_time_hour_s() const {
+    uint32_t on_ms = 0;
+    for (const auto &bucket : minutes) {
+      on_ms += bucket.on_ms;
+    }
+    return on_ms / 1000;
+  }
+  uint32_t cycles_hour() const {
+    uint32_t cycles = 0;
+    for (const auto &bucket : minutes) {
+      cycles += bucket.cycles;
+    }
+    return cycles;
+  }
+  uint32_t on_time_day_s() const {
+    uint32_t on_s = 0;
+    for (const auto &bucket : hours) {
+      on_s += bucket.on_s;
+    }
+    return on_s;
+  }
+  uint32_t cycles_day() const {
+    uint32_t cycles = 0;
+    for (const auto &bucket : hours) {
+      cycles += bucket.cycles;
+    }
+    return cycles;
+  }
+  uint32_t mode_time_day_s(uint8_t climate_mode) const {
+    uint32_t mode_s = 0;
+    for (const auto &bucket : hours) {
+      mode_s += bucket.mode_s[climate_mode];
+    }
+    return mode_s;
+  }
+
+ protected:
+  void close_minute_() {
+    HlinkDutyCycleHour &current_hour = hours[hour];
+    current_hour.on_s += (minutes[minute].on_ms + 500) / 1000;
+    for (uint8_t i = 0; i < DUTY_CYCLE_MODES; i++) {
+      current_hour.mode_s[i] += (minute_mode_ms[i] + 500) / 1000;
+      minute_mode_ms[i] = 0;
+    }
+    minute = (minute + 1) % DUTY_CYCLE_MINUTES;
+    minutes[minute] = {};
+    if (++closed_minutes_in_hour >= DUTY_CYCLE_MINUTES) {
+      closed_minutes_in_hour = 0;
+      hour = (hour + 1) % DUTY_CYCLE_HOURS;
+      hours[hour] = {};
+    }
+  }
+};
+
+constexpr int8_t HLINK_HISTORY_NO_TEMPERATURE = INT8_MIN;
+constexpr uint8_t HLINK_HISTORY_POWER_KNOWN = 0x80;
+constexpr uint8_t HLINK_HISTORY_POWER_ON = 0x40;
+constexpr uint8_t HLINK_HISTORY_ACTION_MASK = 0x0F;
+constexpr uint8_t HLINK_HISTORY_NO_ACTION = HLINK_HISTORY_ACTION_MASK;
+
+struct HlinkHistorySample {
+  // Seconds since the previous sample, saturated
+  uint16_t delta_s;
+  int8_t indoor_temperature;
+  int8_t outdoor_temperature;
+  // HLINK_HISTORY_POWER_* bits and the climate action in the low nibble
+  uint8_t flags;
+};
+
+// Downsampled status kept on the device and exported on demand, so raw sensor publishes can be throttled
+struct HlinkHistory {
+  // Samples are allocated once when the history is configured
+  std::vector<HlinkHistorySample> samples;
+  uint16_t head = 0;
+  uint16_t count = 0;
+  uint32_t resolution_ms = 0;
+  uint32_t last_sample_at_ms = 0;
+  bool throttle_publishes = false;
+
+  void configure(uint16_t size, uint32_t resolution, bool throttle) {
+    samples.assign(size, HlinkHistorySample{});
+    head = 0;
+    count = 0;
+    resolution_ms = resolution;
+    throttle_publishes = throttle;
+  }
+  bool is_enabled() const { return !samples.empty(); }
+  bool is_sample_due(uint32_t now) const {
+    return is_enabled() && (count == 0 || now - last_sample_at_ms >= resolution_ms);
+  }
+
+  void add(int8_t indoor_temperature, int8_t outdoor_temperature, uint8_t flags, uint32_t now) {
+    uint32_t delta_s = count == 0 ? 0 : (now - last_sample_at_ms) / 1000;
+    samples[head] = {static_cast<uint16_t>(std::min<uint32_t>(delta_s, UINT16_MAX)), indoor_temperature,
+                     outdoor_temperature, flags};
+    head = (head + 1) % samples.size();
+    if (count < samples.size()) {
+      count++;
+    }
+    last_sample_at_ms = now;
+  }
+
+  // Index 0 is the newest sample
+  const HlinkHistorySample &newest(uint16_t index) const {
+    return samples[(head + samples.size() - 1 - index) % samples.size()];
+  }
+};
+
+constexpr uint32_t DEFAULT_PASSIVE_LEARNING_PERIOD = 60 * 1000;
+
+// Passive mode decodes the traffic of another master on the bus, e.g. a cloud adapter or a central controller
+struct HlinkBusSniffer {
+  char buffer[HLINK_MSG_READ_BUFFER_SIZE];
+  uint8_t length = 0;
+  // Last request seen on the bus, waiting for its response
+  optional<HlinkRequestFrame> pending_request;
+  uint32_t pending_request_at_ms = 0;
+  uint32_t last_byte_at_ms = 0;
+  uint32_t decoded_responses = 0;
+  uint32_t foreign_frames = 0;
+  uint32_t noise_frames = 0;
 };
 
 struct ComponentStatus {
   HlinkComponentState state = IDLE;
   std::string hlink_response_buffer = std::string(HLINK_MSG_READ_BUFFER_SIZE, '\0');
   uint8_t hlink_response_buffer_index = 0;
-  std::unique_ptr<HlinkRequest> current_request = nullptr;
-  std::vector<HlinkRequest> polling_features = {};
+  // Request in flight, kept in place instead of on the heap
+  HlinkRequest current_request;
+  bool has_current_request = false;
+  const HlinkPollingDescriptor *polling_descriptors = nullptr;
+  const HlinkPollingSubscriber *polling_subscribers = nullptr;
+  HlinkPollingFeature *polling_features = nullptr;
+  uint8_t polling_features_count = 0;
   optional<HlinkRequest> low_priority_hlink_request = {};
   int16_t requested_feature_index = -1;
   uint32_t status_update_interval_ms = DEFAULT_STATUS_UPDATE_INTERVAL;
   uint32_t non_idle_timeout_limit_ms = 0;
+  uint32_t last_status_polling_started_at_ms = 0;
   uint32_t last_status_polling_finished_at_ms = 0;
+  uint32_t last_polling_cycle_ms = 0;
+  // Wraps around, only differences between cycle numbers are used
+  uint16_t completed_polling_cycles = 0;
   uint32_t last_frame_received_at_ms = 0;
   uint32_t timeout_counter_started_at_ms = 0;
+  uint32_t frame_sent_at_ms = 0;
+  uint32_t retry_request_at_ms = 0;
   uint8_t requests_left_to_apply = 0;
+  HlinkResponseTimes response_times = HlinkResponseTimes();
+#ifdef HLINK_AC_RAW_COMMANDS
+  HlinkReadCache read_cache = HlinkReadCache();
+#endif
 
   void refresh_non_idle_timeout(uint32_t non_idle_timeout_limit_ms) {
     this->timeout_counter_started_at_ms = millis();
@@ -218,9 +951,15 @@ struct ComponentStatus {
     return millis() - last_frame_received_at_ms > MIN_INTERVAL_BETWEEN_REQUESTS;
   }
 
+  bool reached_frame_timeout() { return millis() - frame_sent_at_ms > response_times.frame_timeout_ms; }
+
+  void record_frame_timeout() { response_times.add_timeout(); }
+
+  bool can_retry_request() { return static_cast<int32_t>(millis() - retry_request_at_ms) >= 0; }
+
   bool can_start_next_polling() { return (last_status_polling_finished_at_ms + status_update_interval_ms) < millis(); }
 
-  HlinkRequest get_currently_polling_feature() { return polling_features[requested_feature_index]; }
+  HlinkPollingFeature &get_currently_polling_feature() { return polling_features[requested_feature_index]; }
 
   void reset_state() {
     state = IDLE;
@@ -229,7 +968,7 @@ struct ComponentStatus {
     last_status_polling_finished_at_ms = 0;
     requested_feature_index = -1;
     requests_left_to_apply = 0;
-    current_request = nullptr;
+    has_current_request = false;
   }
 
   void reset_response_buffer() {
@@ -238,6 +977,91 @@ struct ComponentStatus {
   }
 };
 
+enum class CustomRegisterType : uint8_t {
+  INT8,
+  UINT8,
+  INT16,
+  UINT16,
+  BITFIELD,
+};
+
+// Model-specific register decoded straight into a float: value = raw * scale + offset
+struct HlinkCustomRegister {
+  CustomRegisterType type = CustomRegisterType::UINT16;
+  uint16_t address = 0;
+  // Bits of the raw value covered by a BITFIELD register
+  uint16_t bitmask = 0xFFFF;
+  float scale = 1.0f;
+  float offset = 0.0f;
+  // Last raw value, BITFIELD writes keep the bits outside of the mask
+  optional<uint16_t> raw_value;
+  uint8_t raw_size = 0;
+#ifdef USE_SENSOR
+  sensor::Sensor *sensor = nullptr;
+#endif
+#ifdef USE_NUMBER
+  number::Number *number = nullptr;
+#endif
+
+  optional<float> decode(const HlinkResponseFrame &response) {
+    optional<uint16_t> raw = response.p_value_as_uint16();
+    if (!raw.has_value()) {
+      return {};
+    }
+    raw_value = raw;
+    raw_size = response.p_value->size() == 1 ? 1 : 2;
+    int32_t value;
+    switch (type) {
+      case CustomRegisterType::INT8:
+        value = static_cast<int8_t>(raw.value() & 0xFF);
+        break;
+      case CustomRegisterType::UINT8:
+        value = raw.value() & 0xFF;
+        break;
+      case CustomRegisterType::INT16:
+        value = static_cast<int16_t>(raw.value());
+        break;
+      case CustomRegisterType::BITFIELD:
+        value = (raw.value() & bitmask) >> __builtin_ctz(bitmask);
+        break;
+      default:
+        value = raw.value();
+        break;
+    }
+    return value * scale + offset;
+  }
+
+  optional<HlinkRequestFrame> encode(float value) const {
+    int32_t raw = lroundf((value - offset) / scale);
+    switch (type) {
+      case CustomRegisterType::INT8:
+        raw = std::clamp<int32_t>(raw, INT8_MIN, INT8_MAX);
+        return HlinkRequestFrame::with_uint8(HlinkRequestFrame::Type::ST, address, static_cast<uint8_t>(raw));
+      case CustomRegisterType::UINT8:
+        raw = std::clamp<int32_t>(raw, 0, UINT8_MAX);
+        return HlinkRequestFrame::with_uint8(HlinkRequestFrame::Type::ST, address, static_cast<uint8_t>(raw));
+      case CustomRegisterType::INT16:
+        raw = std::clamp<int32_t>(raw, INT16_MIN, INT16_MAX);
+        return HlinkRequestFrame::with_uint16(HlinkRequestFrame::Type::ST, address, static_cast<uint16_t>(raw));
+      case CustomRegisterType::BITFIELD: {
+        if (!raw_value.has_value()) {
+          // Other bits of the register are unknown until it's read once
+          return {};
+        }
+        uint16_t bits = (raw_value.value() & ~bitmask) | ((raw << __builtin_ctz(bitmask)) & bitmask);
+        if (raw_size == 1) {
+          return HlinkRequestFrame::with_uint8(HlinkRequestFrame::Type::ST, address, static_cast<uint8_t>(bits));
+        }
+        return HlinkRequestFrame::with_uint16(HlinkRequestFrame::Type::ST, address, bits);
+      }
+      default:
+        raw = std::clamp<int32_t>(raw, 0, UINT16_MAX);
+        return HlinkRequestFrame::with_uint16(HlinkRequestFrame::Type::ST, address, static_cast<uint16_t>(raw));
+    }
+  }
+};
+
+#ifdef HLINK_AC_RAW_COMMANDS
 struct SendHlinkCmdResult {
   std::string result_status;
   std::string cmd_type;
@@ -246,10 +1070,42 @@ struct SendHlinkCmdResult {
   optional<std::string> response_data;
 };
 
+constexpr uint16_t MAX_HLINK_CMD_BATCH_SIZE = 256;
+
+// Raw commands sent one by one through the low priority slot, results are reported once the last one completes
+struct HlinkCmdBatch {
+  std::vector<HlinkRequestFrame> commands;
+  uint16_t next_command = 0;
+  uint16_t completed_commands = 0;
+  bool json_result = false;
+  bool force_read = false;
+  std::string result;
+
+  bool is_running() const { return !commands.empty(); }
+  bool has_unsent_commands() const { return next_command < commands.size(); }
+};
+#endif
+
 #ifdef USE_SENSOR
 enum class SensorType {
   OUTDOOR_TEMPERATURE = 0,
   INDOOR_TEMPERATURE = 1,
+  REQUEST_RETRIES = 2,
+  DROPPED_REQUESTS = 3,
+  BUS_CONTENTION = 4,
+  LOOP_HEAP_ALLOCATIONS = 5,
+  CONTROL_LATENCY_LAST = 6,
+  CONTROL_LATENCY_AVERAGE = 7,
+  CONTROL_LATENCY_MAX = 8,
+  COMPRESSOR_ON_TIME_HOUR = 9,
+  COMPRESSOR_ON_TIME_DAY = 10,
+  COMPRESSOR_CYCLES_HOUR = 11,
+  COMPRESSOR_MEAN_RUN_TIME = 12,
+  HEAT_TIME_DAY = 13,
+  COOL_TIME_DAY = 14,
+  DRY_TIME_DAY = 15,
+  FAN_ONLY_TIME_DAY = 16,
+  HEAT_COOL_TIME_DAY = 17,
   // Used to count the number of sensors in the enum
   COUNT,
 };
@@ -257,16 +1113,135 @@ enum class SensorType {
 #ifdef USE_BINARY_SENSOR
 enum class BinarySensorType {
   AIR_FILTER_WARNING = 0,
+  FAULT = 1,
   COUNT,
 };
 #endif
 #ifdef USE_TEXT_SENSOR
 enum class TextSensorType {
   MODEL_NAME,
+  ALARM,
   COUNT,
 };
+
+constexpr uint8_t HLINK_ALARM_DESCRIPTION_SIZE = 112;
+
+// Alarm descriptions are generated by codegen from hlink_alarm_codes.csv and kept in flash (PROGMEM)
+struct HlinkAlarmCode {
+  uint16_t code;
+  char description[HLINK_ALARM_DESCRIPTION_SIZE];
+};
+
+#ifdef HLINK_AC_DEBUG_DISCOVERY
+// Responsive addresses are tracked per block to keep the bitmap small enough for ESP8266 flash preferences
+constexpr uint32_t DEBUG_DISCOVERY_BLOCK_SIZE = 64;
+constexpr uint32_t DEBUG_DISCOVERY_ADDRESS_SPACE = 0x10000;
+constexpr uint16_t DEBUG_DISCOVERY_BITMAP_SIZE = DEBUG_DISCOVERY_ADDRESS_SPACE / DEBUG_DISCOVERY_BLOCK_SIZE / 8;
+
+constexpr uint16_t DEBUG_DISCOVERY_BATCH_BUFFER_SIZE = 256;
+constexpr uint8_t DEFAULT_DEBUG_DISCOVERY_BATCH_SIZE = 10;
+constexpr uint32_t DEFAULT_DEBUG_DISCOVERY_BATCH_INTERVAL = 10000;
+// An address that keeps timing out or returning garbage is skipped after this many attempts
+constexpr uint8_t DEBUG_DISCOVERY_MAX_ATTEMPTS = 3;
+#endif
+
+struct DebugTextSensorState {
+  text_sensor::TextSensor *sensor;
+  // Raw value of the last publish, compared before any hex formatting happens
+  HlinkResponsePayload last_value;
+  bool has_value;
+};
+
+#ifdef HLINK_AC_DEBUG_DISCOVERY
+struct DebugDiscoveryCheckpoint {
+  uint32_t next_address;
+  uint16_t end_address;
+  bool in_progress;
+  // Scan only the blocks where responsive addresses were found before
+  bool known_only;
+  uint8_t responsive_blocks[DEBUG_DISCOVERY_BITMAP_SIZE];
+
+  bool is_block_responsive(uint32_t address) const {
+    uint32_t block = address / DEBUG_DISCOVERY_BLOCK_SIZE;
+    return responsive_blocks[block / 8] & (1 << (block % 8));
+  }
+
+  void mark_block_responsive(uint32_t address) {
+    uint32_t block = address / DEBUG_DISCOVERY_BLOCK_SIZE;
+    responsive_blocks[block / 8] |= (1 << (block % 8));
+  }
+
+  void clear_blocks(uint32_t start_address, uint32_t end_address) {
+    for (uint32_t block = start_address / DEBUG_DISCOVERY_BLOCK_SIZE;
+         block <= end_address / DEBUG_DISCOVERY_BLOCK_SIZE; block++) {
+      responsive_blocks[block / 8] &= ~(1 << (block % 8));
+    }
+  }
+
+  bool has_responsive_blocks() const {
+    for (uint8_t byte : responsive_blocks) {
+      if (byte != 0) {
+        return true;
+      }
+    }
+    return false;
+  }
+};
+#endif
+#endif
+
+#ifdef HLINK_AC_ALLOCATION_ACCOUNTING
+constexpr uint32_t ALLOCATION_STATS_PUBLISH_INTERVAL = 60 * 1000;
+
+// Counts the heap allocations of the task that opened a counted scope. Entity publishes and callbacks leave the
+// component for ESPHome core or user code, they run in excluded scopes.
+class HlinkAllocationScope {
+ public:
+  explicit HlinkAllocationScope(bool counted);
+  ~HlinkAllocationScope();
+  // Allocations made in counted scopes since boot
+  static uint32_t allocations();
+
+ protected:
+  void *previous_task_;
+};
+#define HLINK_ALLOCATION_SCOPE() HlinkAllocationScope allocation_scope(true)
+#define HLINK_ALLOCATION_EXCLUDED() HlinkAllocationScope allocation_scope(false)
+
+// Heap allocations made by loop() and control(), after setup() the steady state is expected to make none
+struct HlinkAllocationStats {
+  // Counter value at the end of the previous loop()
+  uint32_t last_counter = 0;
+  uint32_t total = 0;
+  uint32_t max_loop = 0;
+  uint32_t loops_with_allocations = 0;
+  // Max per loop since the last sensor publish
+  uint32_t window_max_loop = 0;
+
+  void add_loop(uint32_t allocations) {
+    if (allocations == 0) {
+      return;
+    }
+    total += allocations;
+    loops_with_allocations++;
+    max_loop = std::max(max_loop, allocations);
+    window_max_loop = std::max(window_max_loop, allocations);
+  }
+};
+#else
+#define HLINK_ALLOCATION_SCOPE()
+#define HLINK_ALLOCATION_EXCLUDED()
 #endif
 
+// Climate state published before an optimistic control, restored if any of its writes fail
+struct ProvisionalClimateSnapshot {
+  climate::ClimateMode mode;
+  float target_temperature;
+  optional<climate::ClimateFanMode> fan_mode;
+  climate::ClimateSwingMode swing_mode;
+  optional<climate::ClimatePreset> preset;
+};
+
 struct InitialTargetTemperatures {
   optional<float> heat_target_temperature;
   optional<float> cool_target_temperature;
@@ -280,21 +1255,109 @@ struct HlinkAcSettings {
   uint8_t reserved;
 };
 
-static const uint8_t REQUESTS_QUEUE_SIZE = 16;
-class CircularRequestsQueue {
+// Set from the requests_queue YAML option
+#ifndef HLINK_AC_REQUESTS_QUEUE_SIZE
+#define HLINK_AC_REQUESTS_QUEUE_SIZE 16
+#endif
+
+enum class RequestsQueueOverflowPolicy : uint8_t {
+  // The new request is dropped
+  REJECT = 0,
+  // The oldest queued request is evicted to make room for the new one
+  DROP_OLDEST = 1,
+  // A queued write to the same address is replaced in place, otherwise the new request is dropped
+  COALESCE_BY_ADDRESS = 2,
+};
+
+enum class RequestsQueueEnqueueResult : uint8_t {
+  ENQUEUED,
+  REJECTED,
+  // The oldest queued request was evicted to make room for the new one
+  EVICTED,
+  // A queued write to the same address was replaced by the new one, which supersedes it
+  COALESCED,
+};
+
+// Fixed-capacity ring of requests preallocated in place, enqueueing and dequeueing never allocate
+template<uint8_t Capacity> class CircularRequestsQueue {
+  static_assert(Capacity > 0, "Requests queue capacity must be positive");
+
  public:
-  int8_t enqueue(std::unique_ptr<HlinkRequest> request);
-  std::unique_ptr<HlinkRequest> dequeue();
-  bool is_empty();
-  bool is_full();
-  uint8_t size();
+  void set_overflow_policy(RequestsQueueOverflowPolicy policy) { this->overflow_policy_ = policy; }
+  RequestsQueueOverflowPolicy get_overflow_policy() const { return this->overflow_policy_; }
+
+  // A rejected request is left untouched. When the result is EVICTED or COALESCED the displaced request is moved
+  // into evicted, so its callbacks can be finalized.
+  RequestsQueueEnqueueResult enqueue(HlinkRequest &&request, HlinkRequest &evicted) {
+    if (this->is_full()) {
+      switch (this->overflow_policy_) {
+        case RequestsQueueOverflowPolicy::DROP_OLDEST:
+          this->dequeue(evicted);
+          break;
+        case RequestsQueueOverflowPolicy::COALESCE_BY_ADDRESS: {
+          HlinkRequest *queued = request.request_frame.type == HlinkRequestFrame::Type::ST
+                                     ? this->find_write_(request.request_frame.p.address)
+                                     : nullptr;
+          if (queued == nullptr) {
+            return RequestsQueueEnqueueResult::REJECTED;
+          }
+          evicted = std::move(*queued);
+          *queued = std::move(request);
+          return RequestsQueueEnqueueResult::COALESCED;
+        }
+        case RequestsQueueOverflowPolicy::REJECT:
+        default:
+          return RequestsQueueEnqueueResult::REJECTED;
+      }
+      this->push_(std::move(request));
+      return RequestsQueueEnqueueResult::EVICTED;
+    }
+    this->push_(std::move(request));
+    return RequestsQueueEnqueueResult::ENQUEUED;
+  }
+
+  // Moves the oldest request out of the queue
+  bool dequeue(HlinkRequest &request) {
+    if (this->is_empty()) {
+      return false;
+    }
+    request = std::move(this->requests_[this->head_]);
+    this->head_ = (this->head_ + 1) % Capacity;
+    this->size_--;
+    return true;
+  }
+
+  bool is_empty() const { return this->size_ == 0; }
+  bool is_full() const { return this->size_ == Capacity; }
+  uint8_t size() const { return this->size_; }
+  static constexpr uint8_t capacity() { return Capacity; }
+  uint8_t high_water_mark() const { return this->high_water_mark_; }
 
  protected:
-  int front_{-1};
-  int rear_{-1};
+  void push_(HlinkRequest &&request) {
+    this->requests_[(this->head_ + this->size_) % Capacity] = std::move(request);
+    this->size_++;
+    this->high_water_mark_ = std::max(this->high_water_mark_, this->size_);
+  }
+
+  // The newest queued write wins, reads are never coalesced since their callbacks expect a value
+  HlinkRequest *find_write_(uint16_t address) {
+    for (uint8_t i = this->size_; i > 0; i--) {
+      HlinkRequest &queued = this->requests_[(this->head_ + i - 1) % Capacity];
+      if (queued.request_frame.type == HlinkRequestFrame::Type::ST && queued.request_frame.p.address == address) {
+        return &queued;
+      }
+    }
+    return nullptr;
+  }
+
+  uint8_t head_{0};
   uint8_t size_{0};
-  std::unique_ptr<HlinkRequest> requests_[REQUESTS_QUEUE_SIZE];
+  uint8_t high_water_mark_{0};
+  RequestsQueueOverflowPolicy overflow_policy_{RequestsQueueOverflowPolicy::REJECT};
+  HlinkRequest requests_[Capacity];
 };
+using RequestsQueue = CircularRequestsQueue<HLINK_AC_REQUESTS_QUEUE_SIZE>;
 
 class HlinkAc : public Component, public uart::UARTDevice, public climate::Climate {
 #ifdef USE_SWITCH
@@ -315,27 +1378,78 @@ class HlinkAc : public Component, public uart::UARTDevice, public climate::Clima
  protected:
   void update_sensor_state_(sensor::Sensor *sensor, float value);
   sensor::Sensor *indoor_temperature_sensor_{nullptr};
+  sensor::Sensor *outdoor_temperature_sensor_{nullptr};
+  sensor::Sensor *request_retries_sensor_{nullptr};
+  sensor::Sensor *dropped_requests_sensor_{nullptr};
+  sensor::Sensor *bus_contention_sensor_{nullptr};
+#ifdef HLINK_AC_ALLOCATION_ACCOUNTING
+  sensor::Sensor *loop_heap_allocations_sensor_{nullptr};
+#endif
+  sensor::Sensor *control_latency_last_sensor_{nullptr};
+  sensor::Sensor *control_latency_average_sensor_{nullptr};
+  sensor::Sensor *control_latency_max_sensor_{nullptr};
+  sensor::Sensor *compressor_on_time_hour_sensor_{nullptr};
+  sensor::Sensor *compressor_on_time_day_sensor_{nullptr};
+  sensor::Sensor *compressor_cycles_hour_sensor_{nullptr};
+  sensor::Sensor *compressor_mean_run_time_sensor_{nullptr};
+  // Indexed by climate::ClimateMode
+  sensor::Sensor *mode_time_day_sensors_[DUTY_CYCLE_MODES] = {};
+  // Allocated once a duty cycle sensor is configured
+  std::unique_ptr<HlinkDutyCycle> duty_cycle_{nullptr};
+  void update_duty_cycle_();
 #endif
 #ifdef USE_BINARY_SENSOR
  public:
   void set_binary_sensor(BinarySensorType type, binary_sensor::BinarySensor *s);
+
+ protected:
+  binary_sensor::BinarySensor *air_filter_warning_binary_sensor_{nullptr};
+  binary_sensor::BinarySensor *fault_binary_sensor_{nullptr};
 #endif
 #ifdef USE_TEXT_SENSOR
  public:
   void set_text_sensor(TextSensorType type, text_sensor::TextSensor *sens);
-  void set_debug_text_sensor(uint16_t address, text_sensor::TextSensor *sens);
+  void set_debug_text_sensor(uint8_t index, text_sensor::TextSensor *sens);
+  void set_alarm_codes(const HlinkAlarmCode *alarm_codes, uint8_t count);
+
+ protected:
+  std::vector<DebugTextSensorState> debug_text_sensors_;
+  text_sensor::TextSensor *model_name_text_sensor_{nullptr};
+  text_sensor::TextSensor *alarm_text_sensor_{nullptr};
+  const HlinkAlarmCode *alarm_codes_{nullptr};
+  uint8_t alarm_codes_count_{0};
+#ifdef HLINK_AC_DEBUG_DISCOVERY
+ public:
   void set_debug_discovery_text_sensor(text_sensor::TextSensor *sens);
+  void set_debug_discovery_batching(uint8_t batch_size, uint32_t batch_interval_ms);
 
-  void start_debug_discovery();
+  // Without a start address an interrupted scan is resumed from its last checkpoint
+  void start_debug_discovery(optional<uint16_t> start_address = {}, optional<uint16_t> end_address = {},
+                             bool known_only = false);
   void stop_debug_discovery();
 
  protected:
+  HlinkRequest create_debug_discovery_request_(uint16_t address);
+  void schedule_debug_discovery_(uint32_t address);
+  void retry_debug_discovery_(uint16_t address);
+  void save_debug_discovery_checkpoint_();
   bool debug_discovery_running_{false};
-  text_sensor::TextSensor *model_name_text_sensor_{nullptr};
+  uint8_t debug_discovery_attempts_{0};
+  DebugDiscoveryCheckpoint debug_discovery_{};
+  ESPPreferenceObject debug_discovery_rtc_;
+  void append_debug_discovery_result_(uint16_t address, const HlinkResponseFrame &response);
+  void flush_debug_discovery_results_();
+  // Discovery results are published in batches, space separated: "0001:8010 0002:00"
+  char debug_discovery_batch_[DEBUG_DISCOVERY_BATCH_BUFFER_SIZE];
+  uint16_t debug_discovery_batch_length_{0};
+  uint8_t debug_discovery_batch_count_{0};
+  uint32_t debug_discovery_batch_started_at_ms_{0};
+  uint8_t debug_discovery_batch_size_{DEFAULT_DEBUG_DISCOVERY_BATCH_SIZE};
+  uint32_t debug_discovery_batch_interval_ms_{DEFAULT_DEBUG_DISCOVERY_BATCH_INTERVAL};
   text_sensor::TextSensor *debug_discovery_text_sensor_{nullptr};
+#endif
 #endif
  public:
-  HlinkAc();
   // ----- COMPONENT -----
   void setup() override;
   void loop() override;
@@ -352,30 +1466,139 @@ class HlinkAc : public Component, public uart::UARTDevice, public climate::Clima
   // ----- END CLIMATE -----
 
   void reset_air_filter_clean_warning();
+  void set_custom_register(uint8_t index, uint16_t address, CustomRegisterType type, uint16_t bitmask, float scale,
+                           float offset);
+#ifdef USE_SENSOR
+  void set_custom_register_sensor(uint8_t index, sensor::Sensor *sens);
+#endif
+#ifdef USE_NUMBER
+  void set_custom_register_number(uint8_t index, number::Number *num);
+  void write_custom_register(uint8_t index, float value);
+#endif
+  void set_polling_table(const HlinkPollingDescriptor *descriptors, const HlinkPollingSubscriber *subscribers,
+                         HlinkPollingFeature *features, uint8_t features_count);
   void set_status_update_interval(uint32_t interval_ms);
+  // Codegen estimate of the polling cycle duration for the configured features
+  void set_polling_cycle_estimate(uint32_t estimate_ms) { this->polling_cycle_estimate_ms_ = estimate_ms; }
+  uint32_t get_polling_cycle_estimate() const { return this->polling_cycle_estimate_ms_; }
+  uint32_t get_last_polling_cycle() const { return this->status_.last_polling_cycle_ms; }
+  void set_history(uint16_t size, uint32_t resolution_ms, bool throttle_publishes);
+  // Exports up to max_samples newest samples, oldest first, to the history export callbacks
+  void export_history(uint16_t max_samples = 0);
+  void add_history_export_callback(std::function<void(const std::string &)> &&callback);
+  // Called once per real change of the entity status with the HlinkStatusField bits of the changed fields
+  void add_on_status_change_callback(
+      std::function<void(const HlinkEntityStatus &status, uint16_t changed_fields)> &&callback);
+  const HlinkEntityStatus &get_entity_status() const { return this->hlink_entity_status_; }
+  // Without polling of unseen features the component never reads the bus on its own, control requests are still sent
+  void set_passive_mode(bool poll_unseen_features, uint32_t learning_period_ms);
+  void set_requests_queue_overflow_policy(RequestsQueueOverflowPolicy policy);
+  void set_optimistic(bool optimistic) { this->optimistic_ = optimistic; }
   void set_reference_temperature(float reference_temperature);
   void set_initial_target_temperatures(const InitialTargetTemperatures &config);
-  void send_hlink_cmd(std::string cmd_type, std::string address, optional<std::string> data);
+#ifdef HLINK_AC_RAW_COMMANDS
+  void set_read_cache_ttl(uint32_t ttl_ms);
+  // MT reads are answered from the read cache when it holds a fresh value, unless force_read is set
+  void send_hlink_cmd(std::string cmd_type, std::string address, optional<std::string> data, bool force_read = false);
   void add_send_hlink_cmd_result_callback(std::function<void(const SendHlinkCmdResult &)> &&callback);
+  // Space or comma separated "XXXX" reads and "XXXX=DATA" writes, an optional address range is appended as reads
+  void send_hlink_cmd_batch(const std::string &commands, optional<uint16_t> start_address = {},
+                            optional<uint16_t> end_address = {}, bool json_result = false, bool force_read = false);
+  void add_send_hlink_cmd_batch_result_callback(std::function<void(const std::string &)> &&callback);
+#endif
 
  protected:
   ComponentStatus status_ = ComponentStatus();
+  void run_state_machine_();
+#ifdef HLINK_AC_ALLOCATION_ACCOUNTING
+  HlinkAllocationStats allocation_stats_{};
+#endif
+  // Indexes match the entity indexes of the generated polling table
+  std::vector<HlinkCustomRegister> custom_registers_;
+  HlinkCustomRegister &get_custom_register_(uint8_t index);
   HlinkEntityStatus hlink_entity_status_ = HlinkEntityStatus();
   climate::ClimateTraits traits_ = climate::ClimateTraits();
+  // The activity status may be polled for the duty cycle sensors alone, the action is published only when enabled
+  bool support_hvac_actions_{false};
   float reference_temperature_{25.0f};
   InitialTargetTemperatures initial_target_temperatures_;
-  CircularRequestsQueue pending_action_requests_;
+  RequestsQueue pending_action_requests_;
+  uint32_t queue_overflows_{0};
   ESPPreferenceObject rtc_;
+  ESPPreferenceObject capabilities_rtc_;
+#ifdef HLINK_AC_RAW_COMMANDS
   CallbackManager<void(const SendHlinkCmdResult &)> send_hlink_cmd_result_callback_{};
+  CallbackManager<void(const std::string &)> send_hlink_cmd_batch_result_callback_{};
+  HlinkCmdBatch cmd_batch_{};
+  HlinkRequest create_cmd_batch_request_();
+  void append_cmd_batch_result_(const std::string &value);
+  void answer_cmd_batch_from_cache_();
+#endif
+  HlinkPollingDescriptor read_polling_descriptor_(int16_t feature_index) const;
+  HlinkPollingSubscriber read_polling_subscriber_(uint8_t subscriber_index) const;
+  bool is_polling_feature_informative_(const HlinkPollingDescriptor &descriptor) const;
+  void decode_polling_response_(const HlinkPollingSubscriber &subscriber, const HlinkResponseFrame &response);
+  HlinkRequest create_polling_request_(int16_t feature_index);
+  int16_t next_polling_feature_index_(int16_t from_index);
+  void handle_polling_feature_ng_(int16_t feature_index);
+  void handle_polling_feature_no_answer_(int16_t feature_index);
+  void load_capabilities_();
+  void save_capabilities_();
   void request_status_update_();
+  void finish_polling_request_();
+  void apply_current_request_();
+  void handle_request_ack_timeout_();
+  void publish_request_counters_();
+  void publish_alarm_code_(uint16_t alarm_code);
+  HlinkHistory history_{};
+  CallbackManager<void(const HlinkEntityStatus &, uint16_t)> status_change_callback_{};
+  uint32_t polling_cycle_estimate_ms_{0};
+  void notify_status_changes_();
+  CallbackManager<void(const std::string &)> history_export_callback_{};
+  // History and duty cycle, updated after every published status, polled or sniffed
+  void update_status_statistics_();
+  void record_history_sample_();
+  void publish_temperature_sensors_();
+  HlinkControlLatency control_latency_{};
+  void record_control_latency_(const HlinkRequest &request, uint32_t acked_at_ms);
+  void log_latency_stats_(const char *stage, const HlinkLatencyStats &stats) const;
+  uint32_t retried_requests_{0};
+  uint32_t dropped_requests_{0};
   bool handle_hlink_request_response_(const HlinkRequest &request, const HlinkResponseFrame &response);
-  void publish_updates_if_any_();
+  // Returns true when the climate state was published
+  bool publish_updates_if_any_();
+  void publish_climate_state_();
   HlinkResponseFrame read_hlink_frame_();
-  void write_hlink_frame_(HlinkRequestFrame frame);
+  HlinkResponseFrame parse_hlink_response_(const char *frame, uint8_t length);
+  optional<HlinkRequestFrame> parse_hlink_request_(const char *frame, uint8_t length);
+  void sniff_bus_();
+  bool is_bus_quiet_();
+  bool can_send_next_frame_();
+  void record_contention_event_();
+  uint32_t contention_events_{0};
+  void handle_sniffed_frame_(const char *frame, uint8_t length);
+  bool is_sniffed_by_other_master_(const HlinkPollingFeature &feature, uint32_t now) const;
+  bool passive_mode_{false};
+  bool passive_poll_unseen_features_{false};
+  uint32_t passive_learning_period_ms_{DEFAULT_PASSIVE_LEARNING_PERIOD};
+  HlinkBusSniffer sniffer_{};
+  void write_hlink_frame_(const HlinkRequestFrame &frame);
+  void send_frame_(const char *message);
+  // Climate state requested by control() is published right away and rolled back if any of its writes fail
+  bool optimistic_{false};
+  uint8_t provisional_requests_{0};
+  bool provisional_state_failed_{false};
+  ProvisionalClimateSnapshot provisional_snapshot_{};
+  void enqueue_control_request_(HlinkRequestFrame request_frame,
+                                std::function<void(const HlinkResponseFrame &response)> ok_callback = nullptr);
+  void finish_provisional_request_(bool confirmed);
+  void rollback_provisional_state_();
+  // Runs the timeout callback of a request that is given up without a response
+  void time_out_request_(const HlinkRequest &request);
   void enqueue_request_(HlinkRequestFrame request_frame,
                         std::function<void(const HlinkResponseFrame &response)> ok_callback = nullptr,
                         std::function<void()> ng_callback = nullptr, std::function<void()> invalid_callback = nullptr,
-                        std::function<void()> timeout_callback = nullptr);
+                        std::function<void()> timeout_callback = nullptr, bool provisional = false);
   // ----- Utils -----
   bool is_nanable_equal_(float a, float b) { return (std::isnan(a) && std::isnan(b)) || (a == b); }
   bool is_auto_temperature_mode_(uint16_t mode) const {
@@ -0,0 +1,66 @@
+import esphome.codegen as cg
+import esphome.config_validation as cv
+from esphome.components import number
+from esphome.const import (
+    CONF_MAX_VALUE,
+    CONF_MIN_VALUE,
+    CONF_STEP,
+    ENTITY_CATEGORY_CONFIG,
+)
+from ..climate import (
+    CONF_CUSTOM_REGISTER,
+    CONF_HLINK_AC_ID,
+    CUSTOM_REGISTER_SCHEMA,
+    HlinkAc,
+    custom_register_to_code,
+    hlink_ac_ns,
+    validate_custom_register,
+)
+
+CODEOWNERS = ["@lumixen"]
+CustomRegisterNumber = hlink_ac_ns.class_("CustomRegisterNumber", number.Number)
+
+
+def validate_min_max(config):
+    if config[CONF_MIN_VALUE] >= config[CONF_MAX_VALUE]:
+        raise cv.Invalid(f"'{CONF_MIN_VALUE}' must be lower than '{CONF_MAX_VALUE}'")
+    return config
+
+
+CONFIG_SCHEMA = cv.Schema(
+    {
+        cv.GenerateID(CONF_HLINK_AC_ID): cv.use_id(HlinkAc),
+        cv.Optional(CONF_CUSTOM_REGISTER): cv.All(
+            number.number_schema(
+                CustomRegisterNumber,
+                entity_category=ENTITY_CATEGORY_CONFIG,
+            )
+            .extend(CUSTOM_REGISTER_SCHEMA)
+            .extend(
+                {
+                    cv.Required(CONF_MIN_VALUE): cv.float_,
+                    cv.Required(CONF_MAX_VALUE): cv.float_,
+                    cv.Optional(CONF_STEP, default=1): cv.positive_float,
+                }
+            ),
+            validate_custom_register,
+            validate_min_max,
+        ),
+    }
+)
+
+
+async def to_code(config):
+    parent = await cg.get_variable(config[CONF_HLINK_AC_ID])
+
+    if conf := config.get(CONF_CUSTOM_REGISTER):
+        num = await number.new_number(
+            conf,
+            min_value=conf[CONF_MIN_VALUE],
+            max_value=conf[CONF_MAX_VALUE],
+            step=conf[CONF_STEP],
+        )
+        await cg.register_parented(num, parent)
+        index = custom_register_to_code(parent, config)
+        cg.add(num.set_register_index(index))
+        cg.add(parent.set_custom_register_number(index, num))
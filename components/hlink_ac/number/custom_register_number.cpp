@@ -0,0 +1,7 @@
+#include "custom_register_number.h"
+
+namespace esphome {
+namespace hlink_ac {
+void CustomRegisterNumber::control(float value) { this->parent_->write_custom_register(this->register_index_, value); }
+}  // namespace hlink_ac
+}  // namespace esphome
\ No newline at end of file
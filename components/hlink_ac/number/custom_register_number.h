@@ -0,0 +1,18 @@
+#pragma once
+
+#include "esphome/components/number/number.h"
+#include "../hlink_ac.h"
+
+namespace esphome {
+namespace hlink_ac {
+class CustomRegisterNumber : public number::Number, public Parented<HlinkAc> {
+ public:
+  CustomRegisterNumber() = default;
+  void set_register_index(uint8_t index) { this->register_index_ = index; }
+
+ protected:
+  void control(float value) override;
+  uint8_t register_index_{0};
+};
+}  // namespace hlink_ac
+}  // namespace esphome
\ No newline at end of file
@@ -0,0 +1,101 @@
+#pragma once
+
+#include "hlink_ac.h"
+
+namespace esphome {
+namespace hlink_ac {
+
+template<typename Protocol, typename Value> struct EnumMapping {
+  Protocol protocol;
+  Value value;
+};
+
+// Maps protocol values of a register onto an ESPHome enum in both directions. Derived codecs provide the TABLE, the
+// first entry wins when several protocol values map onto the same enum value.
+template<typename Derived, typename ProtocolT, typename ValueT> struct EnumCodec {
+  using Protocol = ProtocolT;
+  using Value = ValueT;
+
+  static optional<Value> decode(uint16_t raw) {
+    for (const auto &mapping : Derived::TABLE) {
+      if (mapping.protocol == raw) {
+        return mapping.value;
+      }
+    }
+    return {};
+  }
+
+  static optional<Protocol> encode(Value value) {
+    for (const auto &mapping : Derived::TABLE) {
+      if (mapping.value == value) {
+        return mapping.protocol;
+      }
+    }
+    return {};
+  }
+};
+
+// Climate OFF isn't a mode on the bus, it's a power state
+struct ClimateModeCodec : EnumCodec<ClimateModeCodec, uint16_t, climate::ClimateMode> {
+  static constexpr EnumMapping<uint16_t, climate::ClimateMode> TABLE[] = {
+      {HLINK_MODE_HEAT, climate::CLIMATE_MODE_HEAT},
+      {HLINK_MODE_COOL, climate::CLIMATE_MODE_COOL},
+      {HLINK_MODE_DRY, climate::CLIMATE_MODE_DRY},
+      {HLINK_MODE_FAN, climate::CLIMATE_MODE_FAN_ONLY},
+      {HLINK_MODE_AUTO, climate::CLIMATE_MODE_HEAT_COOL},
+      {HLINK_MODE_HEAT_AUTO, climate::CLIMATE_MODE_HEAT_COOL},
+      {HLINK_MODE_COOL_AUTO, climate::CLIMATE_MODE_HEAT_COOL},
+      {HLINK_MODE_DRY_AUTO, climate::CLIMATE_MODE_HEAT_COOL},
+  };
+};
+
+struct ClimateFanModeCodec : EnumCodec<ClimateFanModeCodec, uint8_t, climate::ClimateFanMode> {
+  static constexpr EnumMapping<uint8_t, climate::ClimateFanMode> TABLE[] = {
+      {HLINK_FAN_AUTO, climate::CLIMATE_FAN_AUTO},
+      {HLINK_FAN_HIGH, climate::CLIMATE_FAN_HIGH},
+      {HLINK_FAN_MEDIUM, climate::CLIMATE_FAN_MEDIUM},
+      {HLINK_FAN_LOW, climate::CLIMATE_FAN_LOW},
+      {HLINK_FAN_QUIET, climate::CLIMATE_FAN_QUIET},
+  };
+};
+
+struct ClimateSwingModeCodec : EnumCodec<ClimateSwingModeCodec, uint8_t, climate::ClimateSwingMode> {
+  static constexpr EnumMapping<uint8_t, climate::ClimateSwingMode> TABLE[] = {
+      {HLINK_SWING_OFF, climate::CLIMATE_SWING_OFF},
+      {HLINK_SWING_VERTICAL, climate::CLIMATE_SWING_VERTICAL},
+      {HLINK_SWING_HORIZONTAL, climate::CLIMATE_SWING_HORIZONTAL},
+      {HLINK_SWING_BOTH, climate::CLIMATE_SWING_BOTH},
+  };
+};
+
+// Single definition of a register shared by polling (decode) and control (write frame)
+template<uint16_t Address, typename Codec> struct Register {
+  static constexpr uint16_t ADDRESS = Address;
+  using Protocol = typename Codec::Protocol;
+  using Value = typename Codec::Value;
+
+  // The payload is parsed once per response
+  static optional<Value> decode(const HlinkResponseFrame &response) {
+    optional<uint16_t> raw = response.p_value_as_uint16();
+    if (!raw.has_value()) {
+      return {};
+    }
+    return Codec::decode(raw.value());
+  }
+
+  static optional<Protocol> encode(Value value) { return Codec::encode(value); }
+
+  static HlinkRequestFrame write_frame(Protocol protocol) {
+    if constexpr (sizeof(Protocol) == 1) {
+      return HlinkRequestFrame::with_uint8(HlinkRequestFrame::Type::ST, Address, protocol);
+    }
+    return HlinkRequestFrame::with_uint16(HlinkRequestFrame::Type::ST, Address, protocol);
+  }
+};
+
+using ClimateModeRegister = Register<FeatureType::MODE, ClimateModeCodec>;
+using ClimateFanModeRegister = Register<FeatureType::FAN_MODE, ClimateFanModeCodec>;
+using ClimateSwingModeRegister = Register<FeatureType::SWING_MODE, ClimateSwingModeCodec>;
+
+}  // namespace hlink_ac
+}  // namespace esphome
@@ -1,18 +1,28 @@
 import esphome.codegen as cg
 import esphome.config_validation as cv
 from esphome.components import sensor
+from esphome.components.esp32 import add_idf_sdkconfig_option
 from esphome.const import (
+    DEVICE_CLASS_DURATION,
     DEVICE_CLASS_TEMPERATURE,
     ENTITY_CATEGORY_DIAGNOSTIC,
     ICON_RADIATOR,
     ICON_THERMOMETER,
     STATE_CLASS_MEASUREMENT,
+    STATE_CLASS_TOTAL_INCREASING,
     UNIT_CELSIUS,
+    UNIT_HOUR,
+    UNIT_MILLISECOND,
+    UNIT_MINUTE,
 )
 from ..climate import (
+    CONF_CUSTOM_REGISTER,
     CONF_HLINK_AC_ID,
+    CUSTOM_REGISTER_SCHEMA,
     HlinkAc,
+    custom_register_to_code,
     hlink_ac_ns,
+    validate_custom_register,
 )
 
 CODEOWNERS = ["@lumixen"]
@@ -20,6 +30,48 @@ SensorTypeEnum = hlink_ac_ns.enum("SensorType", True)
 
 OUTDOOR_TEMPERATURE = "outdoor_temperature"
 INDOOR_TEMPERATURE = "indoor_temperature"
+REQUEST_RETRIES = "request_retries"
+DROPPED_REQUESTS = "dropped_requests"
+BUS_CONTENTION = "bus_contention"
+LOOP_HEAP_ALLOCATIONS = "loop_heap_allocations"
+CONTROL_LATENCY_LAST = "control_latency_last"
+CONTROL_LATENCY_AVERAGE = "control_latency_average"
+CONTROL_LATENCY_MAX = "control_latency_max"
+COMPRESSOR_ON_TIME_HOUR = "compressor_on_time_hour"
+COMPRESSOR_ON_TIME_DAY = "compressor_on_time_day"
+COMPRESSOR_CYCLES_HOUR = "compressor_cycles_hour"
+COMPRESSOR_MEAN_RUN_TIME = "compressor_mean_run_time"
+HEAT_TIME_DAY = "heat_time_day"
+COOL_TIME_DAY = "cool_time_day"
+DRY_TIME_DAY = "dry_time_day"
+FAN_ONLY_TIME_DAY = "fan_only_time_day"
+HEAT_COOL_TIME_DAY = "heat_cool_time_day"
+
+ICON_REPEAT = "mdi:repeat"
+ICON_CANCEL = "mdi:cancel"
+ICON_TRANSIT_CONNECTION = "mdi:transit-connection-variant"
+ICON_MEMORY = "mdi:memory"
+ICON_TIMER = "mdi:timer-outline"
+ICON_HEAT_PUMP = "mdi:heat-pump-outline"
+ICON_REPEAT_VARIANT = "mdi:repeat-variant"
+
+# Rolling statistics derived from the polled activity status
+DUTY_CYCLE_TIME_SCHEMA = sensor.sensor_schema(
+    unit_of_measurement=UNIT_HOUR,
+    icon=ICON_HEAT_PUMP,
+    accuracy_decimals=2,
+    device_class=DEVICE_CLASS_DURATION,
+    state_class=STATE_CLASS_MEASUREMENT,
+)
+
+CONTROL_LATENCY_SCHEMA = sensor.sensor_schema(
+    unit_of_measurement=UNIT_MILLISECOND,
+    icon=ICON_TIMER,
+    accuracy_decimals=0,
+    device_class=DEVICE_CLASS_DURATION,
+    state_class=STATE_CLASS_MEASUREMENT,
+    entity_category=ENTITY_CATEGORY_DIAGNOSTIC,
+)
 
 SENSOR_TYPES = {
     INDOOR_TEMPERATURE: sensor.sensor_schema(
@@ -37,20 +89,92 @@ SENSOR_TYPES = {
         state_class=STATE_CLASS_MEASUREMENT,
         entity_category=ENTITY_CATEGORY_DIAGNOSTIC,
     ),
+    REQUEST_RETRIES: sensor.sensor_schema(
+        icon=ICON_REPEAT,
+        accuracy_decimals=0,
+        state_class=STATE_CLASS_TOTAL_INCREASING,
+        entity_category=ENTITY_CATEGORY_DIAGNOSTIC,
+    ),
+    DROPPED_REQUESTS: sensor.sensor_schema(
+        icon=ICON_CANCEL,
+        accuracy_decimals=0,
+        state_class=STATE_CLASS_TOTAL_INCREASING,
+        entity_category=ENTITY_CATEGORY_DIAGNOSTIC,
+    ),
+    BUS_CONTENTION: sensor.sensor_schema(
+        icon=ICON_TRANSIT_CONNECTION,
+        accuracy_decimals=0,
+        state_class=STATE_CLASS_TOTAL_INCREASING,
+        entity_category=ENTITY_CATEGORY_DIAGNOSTIC,
+    ),
+    COMPRESSOR_ON_TIME_HOUR: sensor.sensor_schema(
+        unit_of_measurement=UNIT_MINUTE,
+        icon=ICON_HEAT_PUMP,
+        accuracy_decimals=1,
+        device_class=DEVICE_CLASS_DURATION,
+        state_class=STATE_CLASS_MEASUREMENT,
+    ),
+    COMPRESSOR_ON_TIME_DAY: DUTY_CYCLE_TIME_SCHEMA,
+    COMPRESSOR_CYCLES_HOUR: sensor.sensor_schema(
+        icon=ICON_REPEAT_VARIANT,
+        accuracy_decimals=0,
+        state_class=STATE_CLASS_MEASUREMENT,
+    ),
+    COMPRESSOR_MEAN_RUN_TIME: sensor.sensor_schema(
+        unit_of_measurement=UNIT_MINUTE,
+        icon=ICON_HEAT_PUMP,
+        accuracy_decimals=1,
+        device_class=DEVICE_CLASS_DURATION,
+        state_class=STATE_CLASS_MEASUREMENT,
+    ),
+    HEAT_TIME_DAY: DUTY_CYCLE_TIME_SCHEMA,
+    COOL_TIME_DAY: DUTY_CYCLE_TIME_SCHEMA,
+    DRY_TIME_DAY: DUTY_CYCLE_TIME_SCHEMA,
+    FAN_ONLY_TIME_DAY: DUTY_CYCLE_TIME_SCHEMA,
+    HEAT_COOL_TIME_DAY: DUTY_CYCLE_TIME_SCHEMA,
+    CONTROL_LATENCY_LAST: CONTROL_LATENCY_SCHEMA,
+    CONTROL_LATENCY_AVERAGE: CONTROL_LATENCY_SCHEMA,
+    CONTROL_LATENCY_MAX: CONTROL_LATENCY_SCHEMA,
+    # Counted with the ESP-IDF heap hooks, which the prebuilt Arduino framework doesn't enable
+    LOOP_HEAP_ALLOCATIONS: cv.All(
+        sensor.sensor_schema(
+            icon=ICON_MEMORY,
+            accuracy_decimals=0,
+            state_class=STATE_CLASS_MEASUREMENT,
+            entity_category=ENTITY_CATEGORY_DIAGNOSTIC,
+        ),
+        cv.only_with_esp_idf,
+    ),
 }
 
-CONFIG_SCHEMA = cv.Schema(
-    {
-        cv.GenerateID(CONF_HLINK_AC_ID): cv.use_id(HlinkAc),
-    }
-).extend({cv.Optional(type_): schema for type_, schema in SENSOR_TYPES.items()})
+CONFIG_SCHEMA = (
+    cv.Schema(
+        {
+            cv.GenerateID(CONF_HLINK_AC_ID): cv.use_id(HlinkAc),
+            cv.Optional(CONF_CUSTOM_REGISTER): cv.All(
+                sensor.sensor_schema().extend(CUSTOM_REGISTER_SCHEMA),
+                validate_custom_register,
+            ),
+        }
+    )
+    .extend({cv.Optional(type_): schema for type_, schema in SENSOR_TYPES.items()})
+)
 
 
 async def to_code(config):
     parent = await cg.get_variable(config[CONF_HLINK_AC_ID])
 
+    if LOOP_HEAP_ALLOCATIONS in config:
+        cg.add_define("HLINK_AC_ALLOCATION_ACCOUNTING")
+        add_idf_sdkconfig_option("CONFIG_HEAP_USE_HOOKS", True)
+
     for type_ in SENSOR_TYPES:
         if conf := config.get(type_):
             sens = await sensor.new_sensor(conf)
             sensor_type = getattr(SensorTypeEnum, type_.upper())
             cg.add(parent.set_sensor(sensor_type, sens))
+
+    if conf := config.get(CONF_CUSTOM_REGISTER):
+        sens = await sensor.new_sensor(conf)
+        index = custom_register_to_code(parent, config)
+        cg.add(parent.set_custom_register_sensor(index, sens))
@@ -1,34 +1,62 @@
+import csv
+import logging
+from pathlib import Path
+
 from esphome import automation
 import esphome.codegen as cg
+import esphome.final_validate as fv
 import esphome.config_validation as cv
 from esphome.components import text_sensor
 from esphome.const import (
     CONF_ID,
     ENTITY_CATEGORY_DIAGNOSTIC,
 )
+from esphome.core import CORE
+from esphome.helpers import cpp_string_escape
 from ..climate import (
     CONF_HLINK_AC_ID,
     HlinkAc,
+    debug_sensor_configs,
     hlink_ac_ns,
+    hlink_platform_configs,
+    polled_feature_addresses,
 )
 
+_LOGGER = logging.getLogger(__name__)
+
 CODEOWNERS = ["@lumixen"]
 TextSensorTypeEnum = hlink_ac_ns.enum("TextSensorType", True)
+HlinkAlarmCode = hlink_ac_ns.struct("HlinkAlarmCode")
 
 MODEL_NAME = "model_name"
+ALARM = "alarm"
 DEBUG = "debug"
 DEBUG_DISCOVERY = "debug_discovery"
 
 CONF_ADDRESS = "address"
+CONF_START_ADDRESS = "start_address"
+CONF_END_ADDRESS = "end_address"
+CONF_KNOWN_ONLY = "known_only"
+CONF_BATCH_SIZE = "batch_size"
+CONF_BATCH_INTERVAL = "batch_interval"
 
 ICON_BUG = "mdi:bug"
 ICON_INFORMATION = "mdi:information-outline"
+ICON_ALERT = "mdi:alert-circle-outline"
+
+ALARM_CODES_CSV = Path(__file__).parent.parent / "hlink_alarm_codes.csv"
+# Must match HLINK_ALARM_DESCRIPTION_SIZE, the terminating null included
+ALARM_DESCRIPTION_SIZE = 112
 
 TEXT_SENSOR_TYPES = {
     MODEL_NAME: text_sensor.text_sensor_schema(
         icon=ICON_INFORMATION,
         entity_category=ENTITY_CATEGORY_DIAGNOSTIC,
     ),
+    ALARM: text_sensor.text_sensor_schema(
+        icon=ICON_ALERT,
+        entity_category=ENTITY_CATEGORY_DIAGNOSTIC,
+    ),
     DEBUG: text_sensor.text_sensor_schema(
         icon=ICON_BUG,
         entity_category=ENTITY_CATEGORY_DIAGNOSTIC,
@@ -40,6 +68,13 @@ TEXT_SENSOR_TYPES = {
     DEBUG_DISCOVERY: text_sensor.text_sensor_schema(
         icon=ICON_BUG,
         entity_category=ENTITY_CATEGORY_DIAGNOSTIC,
+    ).extend(
+        {
+            cv.Optional(CONF_BATCH_SIZE, default=10): cv.int_range(min=1, max=32),
+            cv.Optional(
+                CONF_BATCH_INTERVAL, default="10s"
+            ): cv.positive_time_period_milliseconds,
+        }
     ),
 }
 
@@ -49,6 +84,36 @@ CONFIG_SCHEMA = cv.Schema(
     }
 ).extend({cv.Optional(type): schema for type, schema in TEXT_SENSOR_TYPES.items()})
 
+
+def _final_validate_debug_address(config):
+    if DEBUG not in config:
+        return config
+    full_config = fv.full_config.get()
+    hlink_ac_id = config[CONF_HLINK_AC_ID]
+    address = config[DEBUG][CONF_ADDRESS]
+    polled = polled_feature_addresses(full_config, hlink_ac_id)
+    if address in polled:
+        _LOGGER.warning(
+            "Debug sensor address %04X is already polled for %s, both will share a single bus read",
+            address,
+            polled[address],
+        )
+    same_address_sensors = [
+        conf
+        for conf in hlink_platform_configs(full_config, "text_sensor", hlink_ac_id)
+        if DEBUG in conf and conf[DEBUG][CONF_ADDRESS] == address
+    ]
+    if len(same_address_sensors) > 1 and same_address_sensors[0] == config:
+        _LOGGER.warning(
+            "%d debug sensors are configured for address %04X, they will share a single bus read",
+            len(same_address_sensors),
+            address,
+        )
+    return config
+
+
+FINAL_VALIDATE_SCHEMA = _final_validate_debug_address
+
 TEXT_SENSOR_ACTION_SCHEMA = cv.Schema(
     {
         cv.GenerateID(CONF_HLINK_AC_ID): cv.use_id(HlinkAc),
@@ -56,6 +121,14 @@ TEXT_SENSOR_ACTION_SCHEMA = cv.Schema(
     }
 )
 
+START_DEBUG_DISCOVERY_ACTION_SCHEMA = TEXT_SENSOR_ACTION_SCHEMA.extend(
+    {
+        cv.Optional(CONF_START_ADDRESS): cv.templatable(cv.hex_uint16_t),
+        cv.Optional(CONF_END_ADDRESS): cv.templatable(cv.hex_uint16_t),
+        cv.Optional(CONF_KNOWN_ONLY): cv.templatable(cv.boolean),
+    }
+)
+
 StartDebugDiscoveryAction = hlink_ac_ns.class_("StartDebugDiscovery", automation.Action)
 StopDebugDiscoveryAction = hlink_ac_ns.class_("StopDebugDiscovery", automation.Action)
 
@@ -63,9 +136,25 @@ StopDebugDiscoveryAction = hlink_ac_ns.class_("StopDebugDiscovery", automation.A
 @automation.register_action(
     "text_sensor.hlink_ac.start_debug_discovery",
     StartDebugDiscoveryAction,
-    TEXT_SENSOR_ACTION_SCHEMA,
+    START_DEBUG_DISCOVERY_ACTION_SCHEMA,
     synchronous=True,
 )
+async def start_debug_discovery_action_to_code(config, action_id, template_arg, args):
+    cg.add_define("HLINK_AC_DEBUG_DISCOVERY")
+    var = cg.new_Pvariable(action_id, template_arg)
+    await cg.register_parented(var, config[CONF_HLINK_AC_ID])
+    if CONF_START_ADDRESS in config:
+        start_address = await cg.templatable(config[CONF_START_ADDRESS], args, cg.uint16)
+        cg.add(var.set_start_address(start_address))
+    if CONF_END_ADDRESS in config:
+        end_address = await cg.templatable(config[CONF_END_ADDRESS], args, cg.uint16)
+        cg.add(var.set_end_address(end_address))
+    if CONF_KNOWN_ONLY in config:
+        known_only = await cg.templatable(config[CONF_KNOWN_ONLY], args, bool)
+        cg.add(var.set_known_only(known_only))
+    return var
+
+
 @automation.register_action(
     "text_sensor.hlink_ac.stop_debug_discovery",
     StopDebugDiscoveryAction,
@@ -73,20 +162,80 @@ StopDebugDiscoveryAction = hlink_ac_ns.class_("StopDebugDiscovery", automation.A
     synchronous=True,
 )
 async def debug_discovery_action_to_code(config, action_id, template_arg, args):
+    cg.add_define("HLINK_AC_DEBUG_DISCOVERY")
     var = cg.new_Pvariable(action_id, template_arg)
     await cg.register_parented(var, config[CONF_HLINK_AC_ID])
     return var
 
 
+def alarm_codes():
+    """Returns {code: description} of the H-link alarm codes listed in hlink_alarm_codes.csv.
+
+    Failures without a dedicated H-link value are skipped, failures sharing a value are merged.
+    """
+    failures = {}
+    with open(ALARM_CODES_CSV, encoding="utf-8", newline="") as codes_file:
+        for row in csv.DictReader(codes_file):
+            data = row["H-LINK Protocol (P= Data)"].strip()
+            if not data.startswith("P="):
+                continue
+            code = int(data[2:], 16)
+            if code == 0:
+                continue
+            remote_code = row["Remote Controller (Failure Diagnosis)"].replace("\u2013", "-")
+            unit, items, _ = failures.setdefault(code, (row["Unit"], [], remote_code))
+            items.append(row["Item"])
+    codes = {}
+    for code, (unit, items, remote_code) in failures.items():
+        description = f"{unit}: {' / '.join(items)} ({remote_code})"
+        if len(description.encode("utf-8")) >= ALARM_DESCRIPTION_SIZE:
+            raise cv.Invalid(f"Alarm {code:04X} description is too long: {description}")
+        codes[code] = description
+    return codes
+
+
+def alarm_codes_to_code(parent, hlink_ac_id):
+    """Emits the alarm descriptions table as flash constants."""
+    codes = alarm_codes()
+    name = f"hlink_ac_alarm_codes_{hlink_ac_id.id}"
+    entries = ", ".join(
+        f"{{0x{code:04X}, {cpp_string_escape(description)}}}"
+        for code, description in codes.items()
+    )
+    cg.add_global(
+        cg.RawStatement(f"static const {HlinkAlarmCode} {name}[] PROGMEM = {{{entries}}};")
+    )
+    cg.add(parent.set_alarm_codes(cg.RawExpression(name), len(codes)))
+
+
 async def to_code(config):
     parent = await cg.get_variable(config[CONF_HLINK_AC_ID])
     for type_ in TEXT_SENSOR_TYPES:
         if conf := config.get(type_):
             sens = await text_sensor.new_text_sensor(conf)
             if type_ == DEBUG:
-                cg.add(parent.set_debug_text_sensor(conf[CONF_ADDRESS], sens))
+                # The sensor is addressed by its entity index in the generated polling table
+                debug_ids = [
+                    debug_conf[CONF_ID].id
+                    for debug_conf in debug_sensor_configs(
+                        CORE.config, config[CONF_HLINK_AC_ID]
+                    )
+                ]
+                cg.add(
+                    parent.set_debug_text_sensor(
+                        debug_ids.index(conf[CONF_ID].id), sens
+                    )
+                )
             elif type_ == DEBUG_DISCOVERY:
+                cg.add_define("HLINK_AC_DEBUG_DISCOVERY")
                 cg.add(parent.set_debug_discovery_text_sensor(sens))
+                cg.add(
+                    parent.set_debug_discovery_batching(
+                        conf[CONF_BATCH_SIZE], conf[CONF_BATCH_INTERVAL]
+                    )
+                )
             else:
+                if type_ == ALARM:
+                    alarm_codes_to_code(parent, config[CONF_HLINK_AC_ID])
                 sensor_type = getattr(TextSensorTypeEnum, type_.upper())
                 cg.add(parent.set_text_sensor(sensor_type, sens))
@@ -0,0 +1,281 @@
+#include "hlink_test_harness.h"
+
+#include <cstdarg>
+#include <fstream>
+#include <new>
+#include <sstream>
+
+namespace {
+uint64_t host_allocations = 0;
+
+void *counted_alloc(std::size_t size) {
+  host_allocations++;
+  return std::malloc(size == 0 ? 1 : size);
+}
+
+void *counted_aligned_alloc(std::size_t size, std::align_val_t alignment) {
+  host_allocations++;
+  auto align = static_cast<std::size_t>(alignment);
+  return std::aligned_alloc(align, (size + align - 1) / align * align);
+}
+}  // namespace
+
+void *operator new(std::size_t size) {
+  void *p = counted_alloc(size);
+  if (p == nullptr)
+    throw std::bad_alloc();
+  return p;
+}
+void *operator new[](std::size_t size) { return operator new(size); }
+void *operator new(std::size_t size, const std::nothrow_t &) noexcept { return counted_alloc(size); }
+void *operator new[](std::size_t size, const std::nothrow_t &) noexcept { return counted_alloc(size); }
+void *operator new(std::size_t size, std::align_val_t alignment) {
+  void *p = counted_aligned_alloc(size, alignment);
+  if (p == nullptr)
+    throw std::bad_alloc();
+  return p;
+}
+void *operator new[](std::size_t size, std::align_val_t alignment) { return operator new(size, alignment); }
+void *operator new(std::size_t size, std::align_val_t alignment, const std::nothrow_t &) noexcept {
+  return counted_aligned_alloc(size, alignment);
+}
+void *operator new[](std::size_t size, std::align_val_t alignment, const std::nothrow_t &) noexcept {
+  return counted_aligned_alloc(size, alignment);
+}
+void operator delete(void *p) noexcept { std::free(p); }
+void operator delete[](void *p) noexcept { std::free(p); }
+void operator delete(void *p, std::size_t) noexcept { std::free(p); }
+void operator delete[](void *p, std::size_t) noexcept { std::free(p); }
+void operator delete(void *p, const std::nothrow_t &) noexcept { std::free(p); }
+void operator delete[](void *p, const std::nothrow_t &) noexcept { std::free(p); }
+void operator delete(void *p, std::align_val_t) noexcept { std::free(p); }
+void operator delete[](void *p, std::align_val_t) noexcept { std::free(p); }
+void operator delete(void *p, std::size_t, std::align_val_t) noexcept { std::free(p); }
+void operator delete[](void *p, std::size_t, std::align_val_t) noexcept { std::free(p); }
+
+namespace esphome {
+
+namespace host {
+uint32_t now_ms = 0;
+
+void log(char level, const char *tag, const char *format, ...) {
+  static const bool enabled = std::getenv("HLINK_TEST_LOG") != nullptr;
+  if (!enabled)
+    return;
+  std::printf("%8u [%c][%s] ", now_ms, level, tag);
+  va_list args;
+  va_start(args, format);
+  std::vprintf(format, args);
+  va_end(args);
+  std::printf("\n");
+}
+}  // namespace host
+
+namespace climate {
+const char *climate_mode_to_string(ClimateMode mode) {
+  static const char *const NAMES[] = {"OFF", "HEAT_COOL", "COOL", "HEAT", "FAN_ONLY", "DRY", "AUTO"};
+  return mode < sizeof(NAMES) / sizeof(NAMES[0]) ? NAMES[mode] : "UNKNOWN";
+}
+const char *climate_fan_mode_to_string(ClimateFanMode fan_mode) {
+  static const char *const NAMES[] = {"ON",     "OFF",   "AUTO",    "LOW",     "MEDIUM",
+                                      "HIGH",   "MIDDLE", "FOCUS", "DIFFUSE", "QUIET"};
+  return fan_mode < sizeof(NAMES) / sizeof(NAMES[0]) ? NAMES[fan_mode] : "UNKNOWN";
+}
+const char *climate_swing_mode_to_string(ClimateSwingMode swing_mode) {
+  static const char *const NAMES[] = {"OFF", "BOTH", "VERTICAL", "HORIZONTAL"};
+  return swing_mode < sizeof(NAMES) / sizeof(NAMES[0]) ? NAMES[swing_mode] : "UNKNOWN";
+}
+const char *climate_action_to_string(ClimateAction action) {
+  static const char *const NAMES[] = {"OFF", "UNKNOWN", "COOLING", "HEATING", "IDLE", "DRYING", "FAN"};
+  return action < sizeof(NAMES) / sizeof(NAMES[0]) ? NAMES[action] : "UNKNOWN";
+}
+}  // namespace climate
+
+namespace hlink_ac {
+namespace testing {
+
+namespace {
+// Line buffered stdout with a static buffer, so printing doesn't allocate while allocations are counted
+char stdout_buffer[BUFSIZ];
+const bool STDOUT_BUFFERED = std::setvbuf(stdout, stdout_buffer, _IOLBF, sizeof(stdout_buffer)) == 0;
+
+uint16_t parse_address(const std::string &frame) { return std::stoul(frame.substr(5, 4), nullptr, 16); }
+}  // namespace
+
+uint64_t allocations() { return host_allocations; }
+
+std::string with_checksum(const std::string &frame) {
+  uint16_t checksum = 0xFFFF;
+  size_t p = frame.find("P=");
+  if (p != std::string::npos) {
+    for (size_t i = p + 2; i + 1 < frame.size(); i += 2) {
+      if (frame[i] == ',')
+        i++;
+      checksum -= std::stoul(frame.substr(i, 2), nullptr, 16);
+    }
+  }
+  char suffix[10];
+  std::snprintf(suffix, sizeof(suffix), " C=%04X\r", checksum);
+  return frame + suffix;
+}
+
+std::vector<TraceFrame> load_trace(const char *name) {
+  std::string path = std::string(HLINK_TEST_TRACES_DIR) + "/" + name;
+  std::ifstream file(path);
+  HLINK_CHECK(file.is_open());
+  std::vector<TraceFrame> trace;
+  std::string line;
+  while (std::getline(file, line)) {
+    if (line.empty() || line[0] == '#')
+      continue;
+    std::istringstream fields(line);
+    TraceFrame frame;
+    fields >> frame.delay_ms;
+    fields >> std::ws;
+    std::getline(fields, frame.frame);
+    frame.frame += '\r';
+    trace.push_back(frame);
+  }
+  return trace;
+}
+
+PollingTable &PollingTable::add(uint16_t address, HlinkDecoder decoder, uint32_t poll_interval_ms,
+                                uint8_t entity_index) {
+  HlinkPollingDescriptor descriptor{};
+  descriptor.address = address;
+  char read_frame[10];
+  std::snprintf(read_frame, sizeof(read_frame), "MT P=%04X", address);
+  std::string frame = with_checksum(read_frame);
+  std::snprintf(descriptor.frame, sizeof(descriptor.frame), "%s", frame.c_str());
+  descriptor.first_subscriber = this->subscribers_.size();
+  descriptor.subscriber_count = 1;
+  descriptor.poll_interval_ms = poll_interval_ms;
+  this->descriptors_.push_back(descriptor);
+  this->subscribers_.push_back({decoder, entity_index});
+  this->features.emplace_back();
+  return *this;
+}
+
+void PollingTable::attach(HlinkAc &ac) {
+  ac.set_polling_table(this->descriptors_.data(), this->subscribers_.data(), this->features.data(),
+                       this->features.size());
+}
+
+PollingTable PollingTable::climate() {
+  PollingTable table;
+  table.add(FeatureType::POWER_STATE, HlinkDecoder::POWER_STATE)
+      .add(FeatureType::MODE, HlinkDecoder::MODE)
+      .add(FeatureType::TARGET_TEMP, HlinkDecoder::TARGET_TEMP)
+      .add(FeatureType::CURRENT_INDOOR_TEMP, HlinkDecoder::CURRENT_INDOOR_TEMP)
+      .add(FeatureType::FAN_MODE, HlinkDecoder::FAN_MODE);
+  return table;
+}
+
+FakeUnit::FakeUnit() {
+  // Running in cool mode: power on, cool, 24 C target, 22 C indoor, auto fan
+  this->set_register(FeatureType::POWER_STATE, "01");
+  this->set_register(FeatureType::MODE, "0040");
+  this->set_register(FeatureType::TARGET_TEMP, "18");
+  this->set_register(FeatureType::CURRENT_INDOOR_TEMP, "16");
+  this->set_register(FeatureType::FAN_MODE, "00");
+}
+
+void FakeUnit::set_ng(uint16_t address, bool ng) {
+  if (ng) {
+    this->ng_.insert(address);
+  } else {
+    this->ng_.erase(address);
+  }
+}
+
+void FakeUnit::set_silent(uint16_t address, bool silent) {
+  if (silent) {
+    this->silent_.insert(address);
+  } else {
+    this->silent_.erase(address);
+  }
+}
+
+std::string FakeUnit::answer(const std::string &frame) {
+  if (frame.size() < 9 || (frame.compare(0, 2, "MT") != 0 && frame.compare(0, 2, "ST") != 0))
+    return "";
+  uint16_t address = parse_address(frame);
+  if (this->silent_.count(address))
+    return "";
+  if (this->ng_.count(address))
+    return with_checksum("NG P=00");
+  if (frame[0] == 'S') {
+    size_t data_start = frame.find(',') + 1;
+    this->registers_[address] = frame.substr(data_start, frame.find(' ', data_start) - data_start);
+    return "OK\r";
+  }
+  auto value = this->registers_.find(address);
+  if (value == this->registers_.end())
+    return with_checksum("NG P=00");
+  return with_checksum("OK P=" + value->second);
+}
+
+void HostBus::play(const std::vector<TraceFrame> &trace) {
+  uint32_t at = host::now_ms;
+  for (const auto &frame : trace) {
+    at += frame.delay_ms;
+    this->deliveries_.emplace(at, frame.frame);
+  }
+}
+
+void HostBus::run(uint32_t duration_ms) {
+  uint32_t end = host::now_ms + duration_ms;
+  while (host::now_ms < end) {
+    host::now_ms += LOOP_TICK_MS;
+    auto next = this->deliveries_.begin();
+    if (next != this->deliveries_.end() && next->first <= host::now_ms && this->ac_.available() == 0) {
+      this->ac_.rx += next->second;
+      this->deliveries_.erase(next);
+    }
+    uint64_t before = allocations();
+    this->ac_.loop();
+    this->component_allocations += allocations() - before;
+    this->collect_sent_frames_();
+  }
+}
+
+void HostBus::control(const climate::ClimateCall &call) {
+  uint64_t before = allocations();
+  this->ac_.control(call);
+  this->component_allocations += allocations() - before;
+  this->collect_sent_frames_();
+}
+
+size_t HostBus::count_sent(const std::string &prefix) const {
+  size_t count = 0;
+  for (const auto &frame : this->sent) {
+    if (frame.compare(0, prefix.size(), prefix) == 0)
+      count++;
+  }
+  return count;
+}
+
+void HostBus::collect_sent_frames_() {
+  size_t start = 0;
+  size_t end;
+  while ((end = this->ac_.tx.find('\r', start)) != std::string::npos) {
+    std::string frame = this->ac_.tx.substr(start, end - start);
+    std::string response = this->unit.answer(frame);
+    if (!response.empty()) {
+      this->deliveries_.emplace(host::now_ms + this->unit.response_delay_ms_, response);
+    }
+    this->sent.push_back(std::move(frame));
+    start = end + 1;
+  }
+  this->ac_.tx.erase(0, start);
+}
+
+void run_test(const char *name, void (*test)()) {
+  host::now_ms = 0;
+  test();
+  std::printf("%s: ok\n", name);
+}
+
+}  // namespace testing
+}  // namespace hlink_ac
+}  // namespace esphome
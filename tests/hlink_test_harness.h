@@ -0,0 +1,137 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "hlink_ac.h"
+
+// Host harness: the component runs against the stub ESPHome headers in tests/stubs, the bus is simulated by HostBus
+// on a fake clock. Set HLINK_TEST_LOG=1 in the environment to print the component log.
+
+#define HLINK_CHECK(condition) \
+  do { \
+    if (!(condition)) { \
+      std::printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #condition); \
+      std::exit(1); \
+    } \
+  } while (0)
+
+#define HLINK_CHECK_EQ(actual, expected) \
+  do { \
+    auto actual_value = (actual); \
+    auto expected_value = (expected); \
+    if (!(actual_value == expected_value)) { \
+      std::printf("%s:%d: check failed: %s == %s (%s != %s)\n", __FILE__, __LINE__, #actual, #expected, \
+                  ::esphome::hlink_ac::testing::describe(actual_value).c_str(), \
+                  ::esphome::hlink_ac::testing::describe(expected_value).c_str()); \
+      std::exit(1); \
+    } \
+  } while (0)
+
+namespace esphome {
+namespace hlink_ac {
+namespace testing {
+
+// One loop() call per tick, the real loop runs at least this often while the UART is busy
+constexpr uint32_t LOOP_TICK_MS = 5;
+// Time the indoor unit takes to answer a frame
+constexpr uint32_t DEFAULT_RESPONSE_DELAY_MS = 40;
+
+template<typename T> std::string describe(const T &value) { return std::to_string(value); }
+inline std::string describe(const std::string &value) { return value; }
+
+// Heap allocations made by the process so far, all operator new variants are counted
+uint64_t allocations();
+
+// Appends the checksum and the CR: "MT P=0001" -> "MT P=0001 C=FFFE\r", "OK P=0040" -> "OK P=0040 C=FFBF\r"
+std::string with_checksum(const std::string &frame);
+
+struct TraceFrame {
+  // Delay after the previous frame of the trace
+  uint32_t delay_ms;
+  // Frame with its CR
+  std::string frame;
+};
+
+// Loads tests/traces/<name>: one "<delay_ms> <frame>" line per frame, the CR is implied, '#' starts a comment
+std::vector<TraceFrame> load_trace(const char *name);
+
+// Polling table as generated by codegen, one subscriber per address
+class PollingTable {
+ public:
+  PollingTable &add(uint16_t address, HlinkDecoder decoder, uint32_t poll_interval_ms = 0, uint8_t entity_index = 0);
+  // The table must outlive the component and stay unchanged once attached
+  void attach(HlinkAc &ac);
+  // power, mode, target temperature, indoor temperature and fan mode: the minimal climate status
+  static PollingTable climate();
+
+  std::vector<HlinkPollingFeature> features;
+
+ protected:
+  std::vector<HlinkPollingDescriptor> descriptors_;
+  std::vector<HlinkPollingSubscriber> subscribers_;
+};
+
+// Indoor unit answering the frames sent by the component
+class FakeUnit {
+ public:
+  FakeUnit();
+  // Hex value returned for reads of the address, e.g. "0040"
+  void set_register(uint16_t address, const std::string &value) { this->registers_[address] = value; }
+  const std::string &get_register(uint16_t address) { return this->registers_[address]; }
+  // Reads and writes of the address are answered with NG
+  void set_ng(uint16_t address, bool ng = true);
+  // Reads and writes of the address are never answered
+  void set_silent(uint16_t address, bool silent = true);
+  void set_response_delay(uint32_t delay_ms) { this->response_delay_ms_ = delay_ms; }
+  // Returns the answer to a frame with its CR, empty when the unit stays silent. Unknown addresses are answered NG.
+  std::string answer(const std::string &frame);
+
+ protected:
+  std::map<uint16_t, std::string> registers_;
+  std::set<uint16_t> ng_;
+  std::set<uint16_t> silent_;
+  uint32_t response_delay_ms_{DEFAULT_RESPONSE_DELAY_MS};
+
+  friend class HostBus;
+};
+
+// Simulated H-link bus between the component, the indoor unit and the frames of another master replayed from a trace
+class HostBus {
+ public:
+  explicit HostBus(HlinkAc &ac) : ac_(ac) {}
+
+  // Schedules the frames of a trace, the first one after its delay from now
+  void play(const std::vector<TraceFrame> &trace);
+  // Advances the clock, calling loop() on every tick
+  void run(uint32_t duration_ms);
+  // Calls control() at the current time, its allocations are counted with the loop allocations
+  void control(const climate::ClimateCall &call);
+  // Number of frames sent by the component starting with the prefix, e.g. "MT P=0102"
+  size_t count_sent(const std::string &prefix) const;
+
+  FakeUnit unit;
+  // Frames sent by the component, without the CR
+  std::vector<std::string> sent;
+  // Heap allocations made by loop() and control()
+  uint64_t component_allocations{0};
+
+ protected:
+  void collect_sent_frames_();
+
+  HlinkAc &ac_;
+  // Frames to deliver to the component by time, a single frame is delivered per tick into an empty UART buffer
+  std::multimap<uint32_t, std::string> deliveries_;
+};
+
+// Runs a named test case and reports it
+void run_test(const char *name, void (*test)());
+
+}  // namespace testing
+}  // namespace hlink_ac
+}  // namespace esphome
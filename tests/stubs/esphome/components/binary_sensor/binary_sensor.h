@@ -0,0 +1,21 @@
+#pragma once
+
+#include "esphome/core/component.h"
+
+namespace esphome {
+namespace binary_sensor {
+
+class BinarySensor : public EntityBase {
+ public:
+  bool state{false};
+  uint32_t publishes{0};
+
+  bool has_state() const { return this->publishes > 0; }
+  void publish_state(bool state) {
+    this->state = state;
+    this->publishes++;
+  }
+};
+
+}  // namespace binary_sensor
+}  // namespace esphome
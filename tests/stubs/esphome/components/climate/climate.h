@@ -0,0 +1,135 @@
+#pragma once
+
+#include <set>
+#include "esphome/core/component.h"
+
+namespace esphome {
+namespace climate {
+
+enum ClimateMode : uint8_t {
+  CLIMATE_MODE_OFF = 0,
+  CLIMATE_MODE_HEAT_COOL = 1,
+  CLIMATE_MODE_COOL = 2,
+  CLIMATE_MODE_HEAT = 3,
+  CLIMATE_MODE_FAN_ONLY = 4,
+  CLIMATE_MODE_DRY = 5,
+  CLIMATE_MODE_AUTO = 6,
+};
+enum ClimateAction : uint8_t {
+  CLIMATE_ACTION_OFF = 0,
+  CLIMATE_ACTION_COOLING = 2,
+  CLIMATE_ACTION_HEATING = 3,
+  CLIMATE_ACTION_IDLE = 4,
+  CLIMATE_ACTION_DRYING = 5,
+  CLIMATE_ACTION_FAN = 6,
+};
+enum ClimateFanMode : uint8_t {
+  CLIMATE_FAN_ON = 0,
+  CLIMATE_FAN_OFF = 1,
+  CLIMATE_FAN_AUTO = 2,
+  CLIMATE_FAN_LOW = 3,
+  CLIMATE_FAN_MEDIUM = 4,
+  CLIMATE_FAN_HIGH = 5,
+  CLIMATE_FAN_MIDDLE = 6,
+  CLIMATE_FAN_FOCUS = 7,
+  CLIMATE_FAN_DIFFUSE = 8,
+  CLIMATE_FAN_QUIET = 9,
+};
+enum ClimateSwingMode : uint8_t {
+  CLIMATE_SWING_OFF = 0,
+  CLIMATE_SWING_BOTH = 1,
+  CLIMATE_SWING_VERTICAL = 2,
+  CLIMATE_SWING_HORIZONTAL = 3,
+};
+enum ClimatePreset : uint8_t {
+  CLIMATE_PRESET_NONE = 0,
+  CLIMATE_PRESET_HOME = 1,
+  CLIMATE_PRESET_AWAY = 2,
+};
+enum ClimateFeature : uint32_t {
+  CLIMATE_SUPPORTS_CURRENT_TEMPERATURE = 1 << 0,
+  CLIMATE_SUPPORTS_ACTION = 1 << 2,
+};
+
+using ClimateModeMask = std::set<ClimateMode>;
+using ClimateSwingModeMask = std::set<ClimateSwingMode>;
+using ClimateFanModeMask = std::set<ClimateFanMode>;
+using ClimatePresetMask = std::set<ClimatePreset>;
+
+const char *climate_mode_to_string(ClimateMode mode);
+const char *climate_fan_mode_to_string(ClimateFanMode fan_mode);
+const char *climate_swing_mode_to_string(ClimateSwingMode swing_mode);
+const char *climate_action_to_string(ClimateAction action);
+
+class ClimateTraits {
+ public:
+  void add_supported_mode(ClimateMode mode) {}
+  void set_supported_modes(ClimateModeMask modes) {}
+  void set_supported_swing_modes(ClimateSwingModeMask modes) {}
+  void set_supported_fan_modes(ClimateFanModeMask modes) {}
+  void set_supported_presets(ClimatePresetMask presets) {}
+  void add_supported_preset(ClimatePreset preset) {}
+  void add_feature_flags(uint32_t flags) { this->feature_flags_ |= flags; }
+  bool has_feature_flags(uint32_t flags) const { return (this->feature_flags_ & flags) == flags; }
+
+ protected:
+  uint32_t feature_flags_{0};
+};
+
+class ClimateCall {
+ public:
+  ClimateCall &set_mode(ClimateMode mode) {
+    this->mode_ = mode;
+    return *this;
+  }
+  ClimateCall &set_target_temperature(float target_temperature) {
+    this->target_temperature_ = target_temperature;
+    return *this;
+  }
+  ClimateCall &set_fan_mode(ClimateFanMode fan_mode) {
+    this->fan_mode_ = fan_mode;
+    return *this;
+  }
+  ClimateCall &set_swing_mode(ClimateSwingMode swing_mode) {
+    this->swing_mode_ = swing_mode;
+    return *this;
+  }
+  ClimateCall &set_preset(ClimatePreset preset) {
+    this->preset_ = preset;
+    return *this;
+  }
+  const optional<ClimateMode> &get_mode() const { return this->mode_; }
+  const optional<float> &get_target_temperature() const { return this->target_temperature_; }
+  const optional<ClimateFanMode> &get_fan_mode() const { return this->fan_mode_; }
+  const optional<ClimateSwingMode> &get_swing_mode() const { return this->swing_mode_; }
+  const optional<ClimatePreset> &get_preset() const { return this->preset_; }
+
+ protected:
+  optional<ClimateMode> mode_;
+  optional<float> target_temperature_;
+  optional<ClimateFanMode> fan_mode_;
+  optional<ClimateSwingMode> swing_mode_;
+  optional<ClimatePreset> preset_;
+};
+
+class Climate : public EntityBase {
+ public:
+  ClimateMode mode{CLIMATE_MODE_OFF};
+  ClimateAction action{CLIMATE_ACTION_OFF};
+  float current_temperature{NAN};
+  float target_temperature{NAN};
+  optional<ClimateFanMode> fan_mode;
+  ClimateSwingMode swing_mode{CLIMATE_SWING_OFF};
+  optional<ClimatePreset> preset;
+  // Number of state publishes, for the tests
+  uint32_t publishes{0};
+
+  void publish_state() { this->publishes++; }
+
+ protected:
+  virtual void control(const ClimateCall &call) = 0;
+  virtual ClimateTraits traits() = 0;
+};
+
+}  // namespace climate
+}  // namespace esphome
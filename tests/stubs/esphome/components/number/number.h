@@ -0,0 +1,19 @@
+#pragma once
+
+#include "esphome/core/component.h"
+
+namespace esphome {
+namespace number {
+
+class Number : public EntityBase {
+ public:
+  float state{NAN};
+
+  void publish_state(float state) { this->state = state; }
+
+ protected:
+  virtual void control(float value) = 0;
+};
+
+}  // namespace number
+}  // namespace esphome
@@ -0,0 +1,22 @@
+#pragma once
+
+#include "esphome/core/component.h"
+
+namespace esphome {
+namespace sensor {
+
+class Sensor : public EntityBase {
+ public:
+  float state{NAN};
+  uint32_t publishes{0};
+
+  float get_raw_state() const { return this->state; }
+  bool has_state() const { return this->publishes > 0; }
+  void publish_state(float state) {
+    this->state = state;
+    this->publishes++;
+  }
+};
+
+}  // namespace sensor
+}  // namespace esphome
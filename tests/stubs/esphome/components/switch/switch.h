@@ -0,0 +1,19 @@
+#pragma once
+
+#include "esphome/core/component.h"
+
+namespace esphome {
+namespace switch_ {
+
+class Switch : public EntityBase {
+ public:
+  bool state{false};
+
+  void publish_state(bool state) { this->state = state; }
+
+ protected:
+  virtual void write_state(bool state) = 0;
+};
+
+}  // namespace switch_
+}  // namespace esphome
@@ -0,0 +1,21 @@
+#pragma once
+
+#include "esphome/core/component.h"
+
+namespace esphome {
+namespace text_sensor {
+
+class TextSensor : public EntityBase {
+ public:
+  std::string state;
+  uint32_t publishes{0};
+
+  bool has_state() const { return this->publishes > 0; }
+  void publish_state(const std::string &state) {
+    this->state = state;
+    this->publishes++;
+  }
+};
+
+}  // namespace text_sensor
+}  // namespace esphome
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <string>
+#include "esphome/core/component.h"
+
+namespace esphome {
+namespace uart {
+
+enum UARTParityOptions { UART_CONFIG_PARITY_NONE, UART_CONFIG_PARITY_EVEN, UART_CONFIG_PARITY_ODD };
+
+// Bytes on the bus: the tests append to rx and collect tx. Both are reserved up front, so the UART itself doesn't
+// allocate while the component runs.
+class UARTDevice {
+ public:
+  UARTDevice() {
+    this->rx.reserve(4096);
+    this->tx.reserve(4096);
+  }
+  int available() { return this->rx.size() - this->rx_index_; }
+  bool read_byte(uint8_t *data) {
+    if (this->rx_index_ >= this->rx.size())
+      return false;
+    *data = this->rx[this->rx_index_++];
+    if (this->rx_index_ == this->rx.size()) {
+      this->rx.clear();
+      this->rx_index_ = 0;
+    }
+    return true;
+  }
+  void write_str(const char *str) { this->tx += str; }
+  void check_uart_settings(uint32_t baud_rate, uint8_t stop_bits = 1,
+                           UARTParityOptions parity = UART_CONFIG_PARITY_NONE, uint8_t data_bits = 8) {}
+
+  std::string rx;
+  std::string tx;
+
+ protected:
+  size_t rx_index_{0};
+};
+
+}  // namespace uart
+}  // namespace esphome
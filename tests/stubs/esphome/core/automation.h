@@ -0,0 +1,32 @@
+#pragma once
+
+#include "esphome/core/helpers.h"
+
+namespace esphome {
+
+template<typename T, typename... X> class TemplatableValue {
+ public:
+  TemplatableValue() {}
+  template<typename F> TemplatableValue(F f) {}
+  bool has_value() const { return false; }
+  T value(X... x) { return T{}; }
+};
+
+#define TEMPLATABLE_VALUE(type, name) \
+ protected: \
+  TemplatableValue<type, Ts...> name##_{}; \
+\
+ public: \
+  template<typename V> void set_##name(V name) { this->name##_ = name; }
+
+template<typename... Ts> class Action {
+ public:
+  virtual void play(Ts... x) = 0;
+};
+
+template<typename... Ts> class Trigger {
+ public:
+  void trigger(Ts... x) {}
+};
+
+}  // namespace esphome
@@ -0,0 +1,24 @@
+#pragma once
+
+#include "esphome/core/helpers.h"
+#include "esphome/core/preferences.h"
+
+namespace esphome {
+
+class Component {
+ public:
+  virtual void setup() {}
+  virtual void loop() {}
+  virtual void dump_config() {}
+  virtual float get_setup_priority() const { return 0.0f; }
+  // The scheduler isn't simulated
+  void set_interval(uint32_t interval, std::function<void()> &&f) {}
+};
+
+class EntityBase {
+ public:
+  const char *get_name() const { return ""; }
+  template<typename T> ESPPreferenceObject make_entity_preference(uint32_t version) { return {}; }
+};
+
+}  // namespace esphome
@@ -0,0 +1,18 @@
+#pragma once
+
+#include <cstdint>
+
+#define PROGMEM
+
+namespace esphome {
+
+namespace host {
+// Simulated clock, advanced by the tests
+extern uint32_t now_ms;
+}  // namespace host
+
+inline uint32_t millis() { return host::now_ms; }
+inline uint32_t micros() { return host::now_ms * 1000; }
+inline uint8_t progmem_read_byte(const uint8_t *addr) { return *addr; }
+
+}  // namespace esphome
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace esphome {
+
+template<typename T> using optional = std::optional<T>;
+
+// Formatting is only needed by log arguments, which the tests don't check
+inline std::string format_hex_pretty(const uint8_t *data, size_t length) { return {}; }
+
+template<typename... X> class CallbackManager;
+template<typename... Ts> class CallbackManager<void(Ts...)> {
+ public:
+  void add(std::function<void(Ts...)> &&callback) { this->callbacks_.push_back(std::move(callback)); }
+  void call(Ts... args) {
+    for (auto &callback : this->callbacks_)
+      callback(args...);
+  }
+  size_t size() const { return this->callbacks_.size(); }
+
+ protected:
+  std::vector<std::function<void(Ts...)>> callbacks_;
+};
+
+template<typename T> class Parented {
+ public:
+  Parented() {}
+  Parented(T *parent) : parent_(parent) {}
+  T *get_parent() const { return this->parent_; }
+  void set_parent(T *parent) { this->parent_ = parent; }
+
+ protected:
+  T *parent_{nullptr};
+};
+
+}  // namespace esphome
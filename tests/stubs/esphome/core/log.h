@@ -0,0 +1,20 @@
+#pragma once
+
+#include "esphome/core/helpers.h"
+
+namespace esphome {
+namespace host {
+// Printed only when HLINK_TEST_LOG is set in the environment, the arguments are evaluated either way
+void log(char level, const char *tag, const char *format, ...);
+}  // namespace host
+}  // namespace esphome
+
+#define ESP_LOGE(tag, ...) ::esphome::host::log('E', tag, __VA_ARGS__)
+#define ESP_LOGW(tag, ...) ::esphome::host::log('W', tag, __VA_ARGS__)
+#define ESP_LOGI(tag, ...) ::esphome::host::log('I', tag, __VA_ARGS__)
+#define ESP_LOGD(tag, ...) ::esphome::host::log('D', tag, __VA_ARGS__)
+#define ESP_LOGV(tag, ...) ::esphome::host::log('V', tag, __VA_ARGS__)
+#define ESP_LOGCONFIG(tag, ...) ::esphome::host::log('C', tag, __VA_ARGS__)
+#define LOG_STR_ARG(s) (s)
+#define YESNO(b) ((b) ? "YES" : "NO")
+#define ONOFF(b) ((b) ? "ON" : "OFF")
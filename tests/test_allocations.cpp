@@ -0,0 +1,55 @@
+#include "hlink_test_harness.h"
+
+using namespace esphome;
+using namespace esphome::hlink_ac;
+using namespace esphome::hlink_ac::testing;
+
+namespace {
+constexpr uint32_t MINUTE_MS = 60 * 1000;
+constexpr uint32_t HOUR_MS = 60 * MINUTE_MS;
+
+climate::ClimateCall control_call(int index) {
+  static const climate::ClimateMode MODES[] = {climate::CLIMATE_MODE_COOL, climate::CLIMATE_MODE_HEAT,
+                                               climate::CLIMATE_MODE_OFF};
+  climate::ClimateCall call;
+  call.set_mode(MODES[index % 3]).set_target_temperature(20.0f + index % 5);
+  call.set_fan_mode(index % 2 == 0 ? climate::CLIMATE_FAN_AUTO : climate::CLIMATE_FAN_LOW);
+  call.set_swing_mode(index % 2 == 0 ? climate::CLIMATE_SWING_OFF : climate::CLIMATE_SWING_VERTICAL);
+  return call;
+}
+
+// Steady-state polling and optimistic control requests stay off the heap, including the failed writes rolled back
+void test_steady_state_without_allocations() {
+  HlinkAc ac;
+  PollingTable table = PollingTable::climate();
+  table.add(FeatureType::SWING_MODE, HlinkDecoder::SWING_MODE)
+      .add(FeatureType::CURRENT_OUTDOOR_TEMP, HlinkDecoder::CURRENT_OUTDOOR_TEMP)
+      .add(FeatureType::ACTIVITY_STATUS, HlinkDecoder::ACTIVITY_STATUS);
+  table.attach(ac);
+  sensor::Sensor indoor, outdoor;
+  ac.set_sensor(SensorType::INDOOR_TEMPERATURE, &indoor);
+  ac.set_sensor(SensorType::OUTDOOR_TEMPERATURE, &outdoor);
+  ac.set_optimistic(true);
+  ac.setup();
+  HostBus bus(ac);
+  bus.unit.set_register(FeatureType::SWING_MODE, "00");
+  bus.unit.set_register(FeatureType::CURRENT_OUTDOOR_TEMP, "1C");
+  bus.unit.set_register(FeatureType::ACTIVITY_STATUS, "FFFF");
+  bus.run(MINUTE_MS);
+
+  bus.component_allocations = 0;
+  for (int i = 0; i < 36; i++) {
+    // Every third batch has its swing write unanswered and rolled back
+    bus.unit.set_silent(FeatureType::SWING_MODE, i % 3 == 2);
+    bus.control(control_call(i));
+    bus.run(10 * MINUTE_MS);
+  }
+  HLINK_CHECK_EQ(bus.component_allocations, uint64_t(0));
+  HLINK_CHECK(host::now_ms > 6 * HOUR_MS);
+}
+}  // namespace
+
+int main() {
+  run_test("steady_state_without_allocations", test_steady_state_without_allocations);
+  return 0;
+}
@@ -0,0 +1,82 @@
+#include "hlink_test_harness.h"
+
+using namespace esphome;
+using namespace esphome::hlink_ac;
+using namespace esphome::hlink_ac::testing;
+
+namespace {
+constexpr uint32_t MINUTE_MS = 60 * 1000;
+constexpr uint32_t LEARNING_PERIOD_MS = 60 * 1000;
+
+// Traffic of another master is expected on a shared bus, while the component is idle it isn't contention
+void test_foreign_traffic_while_idle(bool passive) {
+  HlinkAc ac;
+  PollingTable table = PollingTable::climate();
+  table.attach(ac);
+  sensor::Sensor contention;
+  ac.set_sensor(SensorType::BUS_CONTENTION, &contention);
+  if (passive) {
+    ac.set_passive_mode(false, LEARNING_PERIOD_MS);
+  } else {
+    // The first polling cycle completes before the other master starts
+    ac.set_status_update_interval(60 * MINUTE_MS);
+  }
+  ac.setup();
+  HostBus bus(ac);
+  bus.run(10 * 1000);
+
+  auto trace = load_trace("adapter_status_round.trace");
+  for (int round = 0; round < 12; round++) {
+    bus.play(trace);
+    bus.run(5000);
+  }
+  HLINK_CHECK(!contention.has_state());
+}
+
+// A control request waiting for the other master to finish its exchange is contention
+void test_foreign_traffic_delaying_control() {
+  HlinkAc ac;
+  PollingTable table = PollingTable::climate();
+  table.attach(ac);
+  sensor::Sensor contention;
+  ac.set_sensor(SensorType::BUS_CONTENTION, &contention);
+  ac.set_passive_mode(false, LEARNING_PERIOD_MS);
+  ac.setup();
+  HostBus bus(ac);
+
+  bus.play(load_trace("adapter_status_round.trace"));
+  bus.run(20);
+  climate::ClimateCall call;
+  call.set_target_temperature(20.0f);
+  bus.control(call);
+  bus.run(2000);
+  HLINK_CHECK(contention.has_state());
+  HLINK_CHECK(contention.state > 0);
+  HLINK_CHECK_EQ(bus.unit.get_register(FeatureType::TARGET_TEMP), std::string("0014"));
+}
+
+// A late answer to a timed out request of the component is neither foreign traffic nor contention
+void test_late_own_response() {
+  HlinkAc ac;
+  PollingTable table;
+  table.add(FeatureType::POWER_STATE, HlinkDecoder::POWER_STATE);
+  table.attach(ac);
+  sensor::Sensor contention;
+  ac.set_sensor(SensorType::BUS_CONTENTION, &contention);
+  ac.setup();
+  HostBus bus(ac);
+  bus.unit.set_response_delay(DEFAULT_FRAME_TIMEOUT + 200);
+
+  bus.run(MINUTE_MS);
+  HLINK_CHECK(bus.count_sent("MT P=0000") > 0);
+  HLINK_CHECK(!contention.has_state());
+}
+}  // namespace
+
+int main() {
+  run_test("foreign_traffic_while_idle_passive", [] { test_foreign_traffic_while_idle(true); });
+  run_test("foreign_traffic_while_idle_active", [] { test_foreign_traffic_while_idle(false); });
+  run_test("foreign_traffic_delaying_control", test_foreign_traffic_delaying_control);
+  run_test("late_own_response", test_late_own_response);
+  return 0;
+}
@@ -0,0 +1,75 @@
+#include "hlink_test_harness.h"
+
+using namespace esphome;
+using namespace esphome::hlink_ac;
+using namespace esphome::hlink_ac::testing;
+
+namespace {
+constexpr uint32_t MINUTE_MS = 60 * 1000;
+
+// A burst of optimistic writes overflowing a coalescing queue: the superseded writes aren't dropped and the newest
+// target temperature stays published
+void test_coalesced_writes_are_superseded() {
+  HlinkAc ac;
+  PollingTable table = PollingTable::climate();
+  table.attach(ac);
+  sensor::Sensor dropped;
+  ac.set_sensor(SensorType::DROPPED_REQUESTS, &dropped);
+  ac.set_requests_queue_overflow_policy(RequestsQueueOverflowPolicy::COALESCE_BY_ADDRESS);
+  ac.set_optimistic(true);
+  ac.setup();
+  HostBus bus(ac);
+  bus.run(MINUTE_MS);
+
+  for (int i = 0; i < HLINK_AC_REQUESTS_QUEUE_SIZE + 4; i++) {
+    climate::ClimateCall call;
+    call.set_target_temperature(16.0f + i % 10);
+    bus.control(call);
+  }
+  float newest = 16.0f + (HLINK_AC_REQUESTS_QUEUE_SIZE + 3) % 10;
+  HLINK_CHECK_EQ(ac.target_temperature, newest);
+  bus.run(MINUTE_MS);
+  HLINK_CHECK_EQ(bus.count_sent("ST P=0003"), size_t(HLINK_AC_REQUESTS_QUEUE_SIZE));
+  HLINK_CHECK_EQ(ac.target_temperature, newest);
+  HLINK_CHECK(!dropped.has_state() || dropped.state == 0.0f);
+}
+
+// Fields without a polled or confirmed value roll back to the state published before the control
+void test_unpolled_fields_roll_back_to_snapshot() {
+  HlinkAc ac;
+  PollingTable table = PollingTable::climate();
+  table.attach(ac);
+  ac.set_optimistic(true);
+  ac.setup();
+  HostBus bus(ac);
+  bus.run(MINUTE_MS);
+  HLINK_CHECK_EQ(ac.swing_mode, climate::CLIMATE_SWING_OFF);
+  HLINK_CHECK(!ac.preset.has_value());
+
+  // Swing isn't polled and its write is never answered
+  bus.unit.set_silent(FeatureType::SWING_MODE);
+  climate::ClimateCall swing;
+  swing.set_swing_mode(climate::CLIMATE_SWING_VERTICAL).set_target_temperature(20.0f);
+  bus.control(swing);
+  HLINK_CHECK_EQ(ac.swing_mode, climate::CLIMATE_SWING_VERTICAL);
+  bus.run(MINUTE_MS);
+  HLINK_CHECK_EQ(ac.swing_mode, climate::CLIMATE_SWING_OFF);
+  // The target temperature write was acknowledged and stays
+  HLINK_CHECK_EQ(ac.target_temperature, 20.0f);
+
+  // Leave home isn't polled and its write is never answered
+  bus.unit.set_silent(FeatureType::LEAVE_HOME_STATUS_WRITE);
+  climate::ClimateCall away;
+  away.set_preset(climate::CLIMATE_PRESET_AWAY);
+  bus.control(away);
+  HLINK_CHECK(ac.preset == climate::CLIMATE_PRESET_AWAY);
+  bus.run(MINUTE_MS);
+  HLINK_CHECK(!ac.preset.has_value());
+}
+}  // namespace
+
+int main() {
+  run_test("coalesced_writes_are_superseded", test_coalesced_writes_are_superseded);
+  run_test("unpolled_fields_roll_back_to_snapshot", test_unpolled_fields_roll_back_to_snapshot);
+  return 0;
+}
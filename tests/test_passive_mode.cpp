@@ -0,0 +1,135 @@
+#include <algorithm>
+
+#include "hlink_test_harness.h"
+
+using namespace esphome;
+using namespace esphome::hlink_ac;
+using namespace esphome::hlink_ac::testing;
+
+namespace {
+constexpr uint32_t LEARNING_PERIOD_MS = 60 * 1000;
+constexpr uint32_t ADAPTER_ROUND_INTERVAL_MS = 5000;
+
+// Sniffed MT requests are paired with the OK responses that follow them and decoded into the entities
+void test_sniffed_frames_are_decoded() {
+  HlinkAc ac;
+  PollingTable table = PollingTable::climate();
+  table.add(FeatureType::CURRENT_OUTDOOR_TEMP, HlinkDecoder::CURRENT_OUTDOOR_TEMP);
+  table.attach(ac);
+  sensor::Sensor outdoor;
+  ac.set_sensor(SensorType::OUTDOOR_TEMPERATURE, &outdoor);
+  ac.set_passive_mode(false, LEARNING_PERIOD_MS);
+  ac.setup();
+  HostBus bus(ac);
+
+  bus.play(load_trace("adapter_status_round.trace"));
+  bus.run(2000);
+  HLINK_CHECK_EQ(ac.mode, climate::CLIMATE_MODE_COOL);
+  HLINK_CHECK_EQ(ac.target_temperature, 24.0f);
+  HLINK_CHECK_EQ(ac.current_temperature, 22.0f);
+  HLINK_CHECK(ac.fan_mode == climate::CLIMATE_FAN_AUTO);
+  HLINK_CHECK(ac.publishes > 0);
+
+  bus.play(load_trace("adapter_pairing_edge_cases.trace"));
+  bus.run(3000);
+  // The response to 0003 isn't attributed to the unanswered 0102 read, the NG response changes nothing
+  HLINK_CHECK(!outdoor.has_state());
+  HLINK_CHECK_EQ(ac.target_temperature, 26.0f);
+  HLINK_CHECK_EQ(ac.mode, climate::CLIMATE_MODE_HEAT);
+  HLINK_CHECK(bus.sent.empty());
+}
+
+// After the learning period only the addresses no other master reads are polled
+void test_unseen_features_are_polled_after_learning() {
+  HlinkAc ac;
+  PollingTable table = PollingTable::climate();
+  table.add(FeatureType::CURRENT_OUTDOOR_TEMP, HlinkDecoder::CURRENT_OUTDOOR_TEMP);
+  table.attach(ac);
+  sensor::Sensor outdoor;
+  ac.set_sensor(SensorType::OUTDOOR_TEMPERATURE, &outdoor);
+  ac.set_passive_mode(true, LEARNING_PERIOD_MS);
+  ac.setup();
+  HostBus bus(ac);
+  bus.unit.set_register(FeatureType::CURRENT_OUTDOOR_TEMP, "1C");
+
+  auto trace = load_trace("adapter_status_round.trace");
+  while (host::now_ms < LEARNING_PERIOD_MS) {
+    bus.play(trace);
+    bus.run(ADAPTER_ROUND_INTERVAL_MS);
+  }
+  HLINK_CHECK(bus.sent.empty());
+
+  for (int round = 0; round < 24; round++) {
+    bus.play(trace);
+    bus.run(ADAPTER_ROUND_INTERVAL_MS);
+  }
+  HLINK_CHECK(bus.count_sent("MT P=0102") > 0);
+  HLINK_CHECK_EQ(bus.count_sent("MT"), bus.count_sent("MT P=0102"));
+  HLINK_CHECK_EQ(bus.count_sent("ST"), size_t(0));
+  HLINK_CHECK(outdoor.has_state());
+  HLINK_CHECK_EQ(outdoor.state, 28.0f);
+}
+
+// Control requests are written, but a passive instance without poll_unseen_features doesn't read them back
+void test_control_without_readback() {
+  HlinkAc ac;
+  PollingTable table = PollingTable::climate();
+  table.attach(ac);
+  ac.set_passive_mode(false, LEARNING_PERIOD_MS);
+  ac.setup();
+  HostBus bus(ac);
+  bus.play(load_trace("adapter_status_round.trace"));
+  bus.run(2000);
+
+  climate::ClimateCall call;
+  call.set_mode(climate::CLIMATE_MODE_HEAT).set_target_temperature(20.0f);
+  bus.control(call);
+  bus.run(30 * 1000);
+  HLINK_CHECK(bus.count_sent("ST P=0001") > 0);
+  HLINK_CHECK(bus.count_sent("ST P=0003") > 0);
+  HLINK_CHECK_EQ(bus.count_sent("MT"), size_t(0));
+  HLINK_CHECK_EQ(bus.unit.get_register(FeatureType::MODE), std::string("0010"));
+  HLINK_CHECK_EQ(bus.unit.get_register(FeatureType::TARGET_TEMP), std::string("0014"));
+}
+
+// History samples and the duty cycle are updated from the sniffed status, no polling cycle ever completes
+void test_statistics_from_sniffed_status() {
+  HlinkAc ac;
+  PollingTable table = PollingTable::climate();
+  table.add(FeatureType::ACTIVITY_STATUS, HlinkDecoder::ACTIVITY_STATUS);
+  table.attach(ac);
+  sensor::Sensor on_time_hour;
+  ac.set_sensor(SensorType::COMPRESSOR_ON_TIME_HOUR, &on_time_hour);
+  ac.set_history(16, 10 * 1000, false);
+  std::string exported;
+  ac.add_history_export_callback([&exported](const std::string &history) { exported = history; });
+  ac.set_passive_mode(false, LEARNING_PERIOD_MS);
+  ac.setup();
+  HostBus bus(ac);
+
+  // The adapter round followed by a read of the activity status, the compressor is running
+  auto trace = load_trace("adapter_status_round.trace");
+  trace.push_back({100, with_checksum("MT P=0301")});
+  trace.push_back({45, with_checksum("OK P=FFFF")});
+  for (uint32_t round = 0; round < 3 * 60 * 1000 / ADAPTER_ROUND_INTERVAL_MS; round++) {
+    bus.play(trace);
+    bus.run(ADAPTER_ROUND_INTERVAL_MS);
+  }
+  HLINK_CHECK(bus.sent.empty());
+  HLINK_CHECK(on_time_hour.has_state());
+  HLINK_CHECK(on_time_hour.state > 1.0f);
+
+  ac.export_history();
+  // "age_s,indoor,outdoor,power,action;159,22,,1,COOLING;149,22,,1,COOLING;..."
+  HLINK_CHECK_EQ(std::count(exported.begin(), exported.end(), ';'), long(16));
+  HLINK_CHECK(exported.find(";9,22,,1,COOLING") != std::string::npos);
+}
+}  // namespace
+
+int main() {
+  run_test("sniffed_frames_are_decoded", test_sniffed_frames_are_decoded);
+  run_test("unseen_features_are_polled_after_learning", test_unseen_features_are_polled_after_learning);
+  run_test("control_without_readback", test_control_without_readback);
+  run_test("statistics_from_sniffed_status", test_statistics_from_sniffed_status);
+  return 0;
+}
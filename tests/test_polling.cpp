@@ -0,0 +1,116 @@
+#include "hlink_test_harness.h"
+
+using namespace esphome;
+using namespace esphome::hlink_ac;
+using namespace esphome::hlink_ac::testing;
+
+namespace {
+constexpr uint32_t MINUTE_MS = 60 * 1000;
+
+// An address that keeps returning NG is re-checked once per interval, also when the re-check isn't answered
+void test_unsupported_feature_recheck() {
+  HlinkAc ac;
+  PollingTable table = PollingTable::climate();
+  table.add(FeatureType::SWING_MODE, HlinkDecoder::SWING_MODE);
+  table.attach(ac);
+  ac.setup();
+  HostBus bus(ac);
+  bus.unit.set_ng(FeatureType::SWING_MODE);
+
+  bus.run(MINUTE_MS);
+  HLINK_CHECK_EQ(bus.count_sent("MT P=0014"), size_t(UNSUPPORTED_FEATURE_NG_THRESHOLD));
+  HLINK_CHECK(table.features.back().unsupported);
+
+  bus.unit.set_silent(FeatureType::SWING_MODE);
+  bus.run(UNSUPPORTED_FEATURE_RECHECK_INTERVAL);
+  HLINK_CHECK_EQ(bus.count_sent("MT P=0014"), size_t(UNSUPPORTED_FEATURE_NG_THRESHOLD + 1));
+  bus.run(UNSUPPORTED_FEATURE_RECHECK_INTERVAL);
+  HLINK_CHECK_EQ(bus.count_sent("MT P=0014"), size_t(UNSUPPORTED_FEATURE_NG_THRESHOLD + 2));
+  HLINK_CHECK(table.features.back().unsupported);
+
+  // Answered again, the address returns to polling
+  bus.unit.set_silent(FeatureType::SWING_MODE, false);
+  bus.unit.set_ng(FeatureType::SWING_MODE, false);
+  bus.unit.set_register(FeatureType::SWING_MODE, "01");
+  bus.run(UNSUPPORTED_FEATURE_RECHECK_INTERVAL + MINUTE_MS);
+  HLINK_CHECK(!table.features.back().unsupported);
+  HLINK_CHECK_EQ(ac.swing_mode, climate::CLIMATE_SWING_VERTICAL);
+}
+
+// Uninformative features are read once per UNINFORMATIVE_FEATURE_POLL_DIVIDER completed cycles, cycles aborted by
+// control requests don't count
+void test_uninformative_feature_divider() {
+  HlinkAc ac;
+  PollingTable table;
+  table.add(FeatureType::CURRENT_OUTDOOR_TEMP, HlinkDecoder::CURRENT_OUTDOOR_TEMP);
+  table.add(FeatureType::POWER_STATE, HlinkDecoder::POWER_STATE)
+      .add(FeatureType::MODE, HlinkDecoder::MODE)
+      .add(FeatureType::TARGET_TEMP, HlinkDecoder::TARGET_TEMP)
+      .add(FeatureType::CURRENT_INDOOR_TEMP, HlinkDecoder::CURRENT_INDOOR_TEMP)
+      .add(FeatureType::FAN_MODE, HlinkDecoder::FAN_MODE);
+  table.attach(ac);
+  ac.setup();
+  HostBus bus(ac);
+  // The outdoor temperature is uninformative while the unit is off
+  bus.unit.set_register(FeatureType::POWER_STATE, "00");
+  bus.unit.set_register(FeatureType::CURRENT_OUTDOOR_TEMP, "7E");
+
+  bus.run(MINUTE_MS);
+  // Control requests preempt the polling cycles started after each applied batch
+  for (int i = 0; i < 100; i++) {
+    climate::ClimateCall call;
+    call.set_target_temperature(i % 2 == 0 ? 20.0f : 21.0f);
+    bus.control(call);
+    bus.run(300);
+  }
+  bus.run(5 * MINUTE_MS);
+
+  // The fan mode is read last, a cycle that sent it has completed
+  size_t outdoor_polls = 0;
+  size_t completed_cycles = 0;
+  for (const auto &frame : bus.sent) {
+    if (frame.compare(0, 9, "MT P=0102") == 0) {
+      if (outdoor_polls > 0) {
+        // A cycle aborted after the outdoor read doesn't complete
+        HLINK_CHECK(completed_cycles + 1 >= UNINFORMATIVE_FEATURE_POLL_DIVIDER);
+      }
+      outdoor_polls++;
+      completed_cycles = 0;
+    } else if (frame.compare(0, 9, "MT P=0002") == 0) {
+      completed_cycles++;
+    }
+  }
+  HLINK_CHECK(outdoor_polls >= 5);
+}
+
+// The activity status polled for a duty cycle sensor feeds the statistics, the action only with hvac_actions
+void run_activity_status_poll(bool support_hvac_actions, climate::ClimateAction expected_action) {
+  HlinkAc ac;
+  PollingTable table = PollingTable::climate();
+  table.add(FeatureType::ACTIVITY_STATUS, HlinkDecoder::ACTIVITY_STATUS);
+  table.attach(ac);
+  sensor::Sensor on_time_hour;
+  ac.set_sensor(SensorType::COMPRESSOR_ON_TIME_HOUR, &on_time_hour);
+  ac.set_support_hvac_actions(support_hvac_actions);
+  ac.setup();
+  HostBus bus(ac);
+  bus.unit.set_register(FeatureType::ACTIVITY_STATUS, "FFFF");
+
+  bus.run(2 * MINUTE_MS);
+  HLINK_CHECK(on_time_hour.has_state());
+  HLINK_CHECK(on_time_hour.state > 0.0f);
+  HLINK_CHECK_EQ(ac.action, expected_action);
+}
+
+void test_activity_status_without_hvac_actions() {
+  run_activity_status_poll(false, climate::CLIMATE_ACTION_OFF);
+  run_activity_status_poll(true, climate::CLIMATE_ACTION_COOLING);
+}
+}  // namespace
+
+int main() {
+  run_test("unsupported_feature_recheck", test_unsupported_feature_recheck);
+  run_test("uninformative_feature_divider", test_uninformative_feature_divider);
+  run_test("activity_status_without_hvac_actions", test_activity_status_without_hvac_actions);
+  return 0;
+}
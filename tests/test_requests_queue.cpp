@@ -0,0 +1,132 @@
+#include <chrono>
+
+#include "hlink_test_harness.h"
+
+using namespace esphome;
+using namespace esphome::hlink_ac;
+using namespace esphome::hlink_ac::testing;
+
+namespace {
+using TestQueue = CircularRequestsQueue<4>;
+
+// The request id is kept in enqueued_at_ms, writes also carry it as their value
+HlinkRequest make_request(HlinkRequestFrame::Type type, uint16_t address, uint32_t id, int *ok_id = nullptr) {
+  HlinkRequest request{type == HlinkRequestFrame::Type::ST
+                           ? HlinkRequestFrame::with_uint16(HlinkRequestFrame::Type::ST, address, id)
+                           : HlinkRequestFrame{HlinkRequestFrame::Type::MT, {address}},
+                       [ok_id, id](const HlinkResponseFrame &response) {
+                         if (ok_id != nullptr) {
+                           *ok_id = id;
+                         }
+                       }};
+  request.enqueued_at_ms = id;
+  return request;
+}
+
+void fill(TestQueue &queue, std::initializer_list<std::pair<HlinkRequestFrame::Type, uint16_t>> requests) {
+  uint32_t id = 1;
+  for (const auto &request : requests) {
+    HlinkRequest evicted;
+    HLINK_CHECK(queue.enqueue(make_request(request.first, request.second, id++), evicted) ==
+                RequestsQueueEnqueueResult::ENQUEUED);
+  }
+  HLINK_CHECK(queue.is_full());
+}
+
+std::vector<uint32_t> drain(TestQueue &queue) {
+  std::vector<uint32_t> ids;
+  HlinkRequest request;
+  while (queue.dequeue(request)) {
+    ids.push_back(request.enqueued_at_ms);
+  }
+  return ids;
+}
+
+constexpr auto ST = HlinkRequestFrame::Type::ST;
+constexpr auto MT = HlinkRequestFrame::Type::MT;
+
+void test_reject() {
+  TestQueue queue;
+  queue.set_overflow_policy(RequestsQueueOverflowPolicy::REJECT);
+  fill(queue, {{ST, 0x0000}, {ST, 0x0001}, {ST, 0x0003}, {ST, 0x0002}});
+
+  int ok_id = 0;
+  HlinkRequest request = make_request(ST, 0x0003, 5, &ok_id);
+  HlinkRequest evicted;
+  HLINK_CHECK(queue.enqueue(std::move(request), evicted) == RequestsQueueEnqueueResult::REJECTED);
+  // The rejected request is left to the caller with its callbacks
+  HLINK_CHECK_EQ(request.enqueued_at_ms, uint32_t(5));
+  HLINK_CHECK_EQ(request.request_frame.p.address, uint16_t(0x0003));
+  HLINK_CHECK(request.ok_callback != nullptr);
+  request.ok_callback({});
+  HLINK_CHECK_EQ(ok_id, 5);
+  HLINK_CHECK(evicted.ok_callback == nullptr);
+  HLINK_CHECK(drain(queue) == std::vector<uint32_t>({1, 2, 3, 4}));
+}
+
+void test_drop_oldest() {
+  TestQueue queue;
+  queue.set_overflow_policy(RequestsQueueOverflowPolicy::DROP_OLDEST);
+  fill(queue, {{ST, 0x0000}, {ST, 0x0001}, {ST, 0x0003}, {ST, 0x0002}});
+
+  HlinkRequest evicted;
+  HLINK_CHECK(queue.enqueue(make_request(MT, 0x0003, 5), evicted) == RequestsQueueEnqueueResult::EVICTED);
+  HLINK_CHECK_EQ(evicted.enqueued_at_ms, uint32_t(1));
+  HLINK_CHECK(drain(queue) == std::vector<uint32_t>({2, 3, 4, 5}));
+}
+
+void test_coalesce_by_address() {
+  TestQueue queue;
+  queue.set_overflow_policy(RequestsQueueOverflowPolicy::COALESCE_BY_ADDRESS);
+  fill(queue, {{ST, 0x0003}, {MT, 0x0001}, {ST, 0x0003}, {ST, 0x0002}});
+
+  // Only the newest write to the address is replaced, in place
+  HlinkRequest evicted;
+  HLINK_CHECK(queue.enqueue(make_request(ST, 0x0003, 5), evicted) == RequestsQueueEnqueueResult::COALESCED);
+  HLINK_CHECK_EQ(evicted.enqueued_at_ms, uint32_t(3));
+
+  // Reads are never coalesced, neither as the new request nor as the queued one
+  HlinkRequest read = make_request(MT, 0x0002, 6);
+  HLINK_CHECK(queue.enqueue(std::move(read), evicted) == RequestsQueueEnqueueResult::REJECTED);
+  HLINK_CHECK_EQ(read.enqueued_at_ms, uint32_t(6));
+  HlinkRequest write = make_request(ST, 0x0001, 7);
+  HLINK_CHECK(queue.enqueue(std::move(write), evicted) == RequestsQueueEnqueueResult::REJECTED);
+  HLINK_CHECK_EQ(write.enqueued_at_ms, uint32_t(7));
+
+  HLINK_CHECK(drain(queue) == std::vector<uint32_t>({1, 2, 5, 4}));
+}
+
+// Overflowing enqueues of every policy on a full queue, they never allocate
+void benchmark_overflow(RequestsQueueOverflowPolicy policy, const char *name) {
+  constexpr int ITERATIONS = 1000000;
+  TestQueue queue;
+  queue.set_overflow_policy(policy);
+  fill(queue, {{ST, 0x0000}, {ST, 0x0001}, {ST, 0x0003}, {ST, 0x0002}});
+  HlinkRequest evicted;
+  uint64_t allocations_before = allocations();
+  auto started = std::chrono::steady_clock::now();
+  for (int i = 0; i < ITERATIONS; i++) {
+    HlinkRequest request = make_request(ST, 0x0003, i);
+    queue.enqueue(std::move(request), evicted);
+  }
+  auto elapsed = std::chrono::steady_clock::now() - started;
+  HLINK_CHECK_EQ(allocations() - allocations_before, uint64_t(0));
+  HLINK_CHECK(queue.is_full());
+  std::printf("  %s: %.1f ns per overflowing enqueue\n", name,
+              std::chrono::duration<double, std::nano>(elapsed).count() / ITERATIONS);
+}
+
+void test_overflow_benchmark() {
+  benchmark_overflow(RequestsQueueOverflowPolicy::REJECT, "reject");
+  benchmark_overflow(RequestsQueueOverflowPolicy::DROP_OLDEST, "drop_oldest");
+  benchmark_overflow(RequestsQueueOverflowPolicy::COALESCE_BY_ADDRESS, "coalesce");
+}
+}  // namespace
+
+int main() {
+  run_test("reject", test_reject);
+  run_test("drop_oldest", test_drop_oldest);
+  run_test("coalesce_by_address", test_coalesce_by_address);
+  run_test("overflow_benchmark", test_overflow_benchmark);
+  return 0;
+}